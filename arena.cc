@@ -0,0 +1,164 @@
+#include "arena.h"
+/****************************************************************
+ * Implementation for the 'Arena' and 'ArenaScope' classes.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * The chunks double in size, so a thread's arena settles after a
+ * few precincts at a handful of chunks that hold its biggest
+ * iteration, and Owns() has only those few to look through.
+ *
+**/
+
+#include <algorithm>
+
+thread_local Arena* Arena::current_ = nullptr;
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetBytesAllocated
+ * Returns the bytes handed out since ResetFigures().
+**/
+long long Arena::GetBytesAllocated() const {
+  return bytes_allocated_;
+}
+
+/****************************************************************
+ * Function GetBytesReserved
+ * Returns the bytes of the chunks the arena holds.
+**/
+long long Arena::GetBytesReserved() const {
+  long long bytes = 0;
+  for (auto iter = chunks_.begin(); iter != chunks_.end(); ++iter) {
+    bytes += iter->bytes;
+  }
+  return bytes;
+}
+
+/****************************************************************
+ * Function GetHighWater
+ * Returns the most bytes in use between two Reset() calls since
+ * ResetFigures().
+**/
+long long Arena::GetHighWater() const {
+  return high_water_;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Allocate
+ * Returns 'bytes' of memory aligned for any type, from the chunk
+ * in use if it has room, else from the next chunk that does, else
+ * from a new chunk at least twice the size of the last.
+**/
+void* Arena::Allocate(size_t bytes) {
+  bytes = (bytes + kAlignment - 1) / kAlignment * kAlignment;
+  while ((chunk_ < chunks_.size()) &&
+         (chunk_used_ + bytes > chunks_[chunk_].bytes)) {
+    ++chunk_;
+    chunk_used_ = 0;
+  }
+  if (chunk_ == chunks_.size()) {
+    Chunk chunk;
+    chunk.bytes = chunks_.empty() ? kFirstChunkBytes
+                                  : 2 * chunks_.back().bytes;
+    chunk.bytes = max(chunk.bytes, bytes);
+    chunk.memory.reset(new char[chunk.bytes]);
+    chunks_.push_back(move(chunk));
+  }
+
+  void* pointer = chunks_[chunk_].memory.get() + chunk_used_;
+  chunk_used_ += bytes;
+  bytes_allocated_ += bytes;
+  bytes_in_use_ += bytes;
+  high_water_ = max(high_water_, bytes_in_use_);
+  return pointer;
+}
+
+/****************************************************************
+ * Function Current
+ * Returns this thread's arena while an ArenaScope is open, or null.
+**/
+Arena* Arena::Current() {
+  return current_;
+}
+
+/****************************************************************
+ * Function ForThisThread
+ * Returns the arena that belongs to the calling thread.
+**/
+Arena& Arena::ForThisThread() {
+  static thread_local Arena arena;
+  return arena;
+}
+
+/****************************************************************
+ * Function Owns
+ * Returns true if 'pointer' is in one of the arena's chunks, the
+ * newest looked at first since that is where most frees are.
+**/
+bool Arena::Owns(const void* pointer) const {
+  const char* address = static_cast<const char*>(pointer);
+  for (auto iter = chunks_.rbegin(); iter != chunks_.rend(); ++iter) {
+    const char* start = iter->memory.get();
+    if ((start <= address) && (address < start + iter->bytes))
+      return true;
+  }
+  return false;
+}
+
+/****************************************************************
+ * Function Reset
+ * Takes back everything handed out, keeping the chunks.
+**/
+void Arena::Reset() {
+  chunk_ = 0;
+  chunk_used_ = 0;
+  bytes_in_use_ = 0;
+}
+
+/****************************************************************
+ * Function ResetFigures
+ * Takes the bytes allocated and the high water back to zero.
+**/
+void Arena::ResetFigures() {
+  bytes_allocated_ = 0;
+  high_water_ = bytes_in_use_;
+}
+
+/****************************************************************
+ * Constructor.
+ * Makes this thread's arena current, empty and with its figures
+ * at zero. A scope opened inside another on the same thread
+ * shares its arena and leaves it current when it ends.
+**/
+ArenaScope::ArenaScope() {
+  outer_ = Arena::current_;
+  arena_ = &Arena::ForThisThread();
+  if (nullptr == outer_)
+    arena_->Reset();
+  arena_->ResetFigures();
+  Arena::current_ = arena_;
+}
+
+/****************************************************************
+ * Destructor.
+**/
+ArenaScope::~ArenaScope() {
+  if (nullptr == outer_)
+    arena_->Reset();
+  Arena::current_ = outer_;
+}
+
+/****************************************************************
+ * Function GetArena
+ * Returns the arena the scope made current.
+**/
+Arena& ArenaScope::GetArena() const {
+  return *arena_;
+}
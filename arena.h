@@ -0,0 +1,141 @@
+/****************************************************************
+ * Header for the 'Arena' class and the 'ArenaAllocator' template.
+ *
+ * An Arena hands out memory by moving a pointer along chunks it
+ * got from the heap, and takes it all back in one step with
+ * Reset(), which keeps the chunks for next time. Freeing one
+ * allocation does nothing. That fits the voter maps of a precinct,
+ * which fill up during an iteration and are all emptied at its end.
+ *
+ * Each thread has its own arena, so workers never share one and
+ * never take a lock. It is only used inside an ArenaScope: the
+ * scope makes this thread's arena the current one and takes its
+ * figures back to zero, and the containers whose allocator is an
+ * ArenaAllocator draw from the current arena while there is one
+ * and from the heap otherwise. Memory from the arena must all be
+ * given back before the scope ends, since the next scope on the
+ * thread reuses it.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+class Arena {
+public:
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ Arena() = default;
+ Arena(const Arena&) = delete;
+ Arena& operator=(const Arena&) = delete;
+ virtual ~Arena() = default;
+
+/****************************************************************
+ * Accessors. The bytes handed out since the last ResetFigures(),
+ * the most in use at once since then, and the bytes held.
+**/
+ long long GetBytesAllocated() const;
+ long long GetBytesReserved() const;
+ long long GetHighWater() const;
+
+/****************************************************************
+ * General functions. Current() is null outside an ArenaScope.
+**/
+ void* Allocate(size_t bytes);
+ bool Owns(const void* pointer) const;
+ void Reset();
+ void ResetFigures();
+
+ static Arena* Current();
+ static Arena& ForThisThread();
+
+private:
+ friend class ArenaScope;
+
+ static constexpr size_t kAlignment = alignof(max_align_t);
+ static constexpr size_t kFirstChunkBytes = 64 * 1024;
+
+ struct Chunk {
+   unique_ptr<char[]> memory;
+   size_t bytes = 0;
+ };
+
+ long long bytes_allocated_ = 0;
+ long long bytes_in_use_ = 0;
+ long long high_water_ = 0;
+ size_t chunk_ = 0;
+ size_t chunk_used_ = 0;
+ vector<Chunk> chunks_;
+
+ static thread_local Arena* current_;
+};
+
+/****************************************************************
+ * Makes this thread's arena the current one, with its figures at
+ * zero, until the scope ends.
+**/
+class ArenaScope {
+public:
+ ArenaScope();
+ ArenaScope(const ArenaScope&) = delete;
+ ArenaScope& operator=(const ArenaScope&) = delete;
+ virtual ~ArenaScope();
+
+ Arena& GetArena() const;
+
+private:
+ Arena* arena_ = nullptr;
+ Arena* outer_ = nullptr;
+};
+
+/****************************************************************
+ * A standard allocator that draws from the current arena when
+ * there is one. It has no state, so every two are equal and
+ * containers can swap and copy as they would with the default.
+**/
+template <typename T>
+class ArenaAllocator {
+public:
+ typedef T value_type;
+
+ ArenaAllocator() = default;
+ template <typename U>
+ ArenaAllocator(const ArenaAllocator<U>&) {}
+
+ T* allocate(size_t count) {
+   Arena* arena = Arena::Current();
+   if (nullptr != arena)
+     return static_cast<T*>(arena->Allocate(count * sizeof(T)));
+   return static_cast<T*>(::operator new(count * sizeof(T)));
+ }
+
+ void deallocate(T* pointer, size_t) {
+   Arena* arena = Arena::Current();
+   if ((nullptr != arena) && arena->Owns(pointer))
+     return;
+   ::operator delete(pointer);
+ }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) {
+  return false;
+}
+
+#endif // ARENA_H
@@ -0,0 +1,149 @@
+#include "arrivalplan.h"
+/****************************************************************
+ * Implementation for the 'ArrivalPlan' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * The plans are referred to from plans_, keyed by the expected
+ * voters and the exact hours and percentages they were made from,
+ * so that plans for two configurations that differ only in, say,
+ * the seed are the same plan.
+ *
+**/
+
+#include <cmath>
+#include <new>
+
+mutex ArrivalPlan::plans_mutex_;
+map<pair<int, vector<double> >,
+    weak_ptr<const ArrivalPlan> > ArrivalPlan::plans_;
+
+/****************************************************************
+ * Constructor.
+ * Works out the voters and rate of each hour as CreateVoters
+ * always has: an hour's percent of the expected voters, rounded,
+ * plus one in every even hour to make up for the rounding down.
+**/
+ArrivalPlan::ArrivalPlan(const Configuration& config, int expected_voters) {
+  expected_voters_ = expected_voters;
+  hours_count_ = config.election_day_length_hours_;
+  arrival_zero_ = config.arrival_zero_;
+  arrival_fractions_ = config.arrival_fractions_;
+
+  size_t bytes = hours_count_ * sizeof(Hour);
+  size_t space = bytes + kCacheLineBytes;
+  memory_.reset(new char[space]);
+  void* start = memory_.get();
+  hours_ = static_cast<Hour*>(align(kCacheLineBytes, bytes, start, space));
+
+  voters_at_zero_ = round((arrival_zero_ / 100.0) * expected_voters_);
+  voters_count_ = voters_at_zero_;
+  for (int hour = 0; hour < hours_count_; ++hour) {
+    double percent = arrival_fractions_.at(hour);
+    int voters_this_hour = round((percent / 100.0) * expected_voters_);
+    if (0 == hour%2)
+      ++voters_this_hour;
+
+    Hour* one_hour = new (hours_ + hour) Hour();
+    one_hour->voters = voters_this_hour;
+    one_hour->start_seconds = hour*3600;
+    one_hour->lambda = static_cast<double>(voters_this_hour / 3600.0);
+    if (voters_this_hour > 0)
+      voters_count_ += voters_this_hour;
+  }
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetExpectedVoters
+ * Returns the expected voters the plan was made for.
+**/
+int ArrivalPlan::GetExpectedVoters() const {
+  return expected_voters_;
+}
+
+/****************************************************************
+ * Function GetHour
+ * Returns the plan of one hour.
+**/
+const ArrivalPlan::Hour& ArrivalPlan::GetHour(int hour) const {
+  return hours_[hour];
+}
+
+/****************************************************************
+ * Function GetHoursCount
+ * Returns the number of hours in the day.
+**/
+int ArrivalPlan::GetHoursCount() const {
+  return hours_count_;
+}
+
+/****************************************************************
+ * Function GetVotersAtZero
+ * Returns the voters who arrive as the polls open.
+**/
+int ArrivalPlan::GetVotersAtZero() const {
+  return voters_at_zero_;
+}
+
+/****************************************************************
+ * Function GetVotersCount
+ * Returns the voters of the whole day, those at zero included.
+**/
+int ArrivalPlan::GetVotersCount() const {
+  return voters_count_;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Fits
+ * Returns true if the plan was made for 'expected_voters' and the
+ * hours and arrival percentages of 'config'.
+**/
+bool ArrivalPlan::Fits(const Configuration& config,
+                       int expected_voters) const {
+  return (expected_voters == expected_voters_) &&
+         (config.election_day_length_hours_ == hours_count_) &&
+         (config.arrival_zero_ == arrival_zero_) &&
+         (config.arrival_fractions_ == arrival_fractions_);
+}
+
+/****************************************************************
+ * Function For
+ * Returns the plan for 'config' and 'expected_voters', made now
+ * if no one holds it. Entries for plans no one holds any more
+ * are dropped as new plans are made, so plans_ is never much
+ * bigger than the plans in use.
+**/
+shared_ptr<const ArrivalPlan> ArrivalPlan::For(const Configuration& config,
+                                               int expected_voters) {
+  vector<double> percents;
+  percents.reserve(config.arrival_fractions_.size() + 2);
+  percents.push_back(config.election_day_length_hours_);
+  percents.push_back(config.arrival_zero_);
+  percents.insert(percents.end(), config.arrival_fractions_.begin(),
+                  config.arrival_fractions_.end());
+  pair<int, vector<double> > key(expected_voters, percents);
+
+  lock_guard<mutex> lock(plans_mutex_);
+  auto found = plans_.find(key);
+  if (found != plans_.end()) {
+    shared_ptr<const ArrivalPlan> plan = found->second.lock();
+    if (plan)
+      return plan;
+  }
+  for (auto iter = plans_.begin(); iter != plans_.end(); ) {
+    if (iter->second.expired())
+      iter = plans_.erase(iter);
+    else
+      ++iter;
+  }
+  shared_ptr<const ArrivalPlan> plan(new ArrivalPlan(config, expected_voters));
+  plans_[move(key)] = plan;
+  return plan;
+}
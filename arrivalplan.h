@@ -0,0 +1,103 @@
+/****************************************************************
+ * Header for the 'ArrivalPlan' class.
+ *
+ * An ArrivalPlan is what CreateVoters needs from a configuration's
+ * arrival percentages for one number of expected voters: the
+ * voters at zero and, for each hour, the voters that arrive in it,
+ * with the extra voter of every even hour, and their rate per
+ * second. It is worked out once, when the plan is made, instead of
+ * on every day created.
+ *
+ * A plan never changes once made, so one plan is shared read-only
+ * by every precinct, station count, iteration and thread with the
+ * same expected voters and arrival percentages. For() hands out
+ * the plans, making each when it is asked for and none is held;
+ * the registry only refers to a plan, which goes when the last
+ * precinct holding it lets go, so a server or budget run that
+ * asks for many turnouts does not keep them all. Fits() lets a
+ * precinct that holds a plan check it is still the one wanted
+ * without the lock For() takes.
+ *
+ * The hours are kept sixteen bytes each in one block that starts
+ * on a cache line, so a day of thirteen hours is four lines and
+ * a walk over the hours reads them in order.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef ARRIVALPLAN_H
+#define ARRIVALPLAN_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "configuration.h"
+
+class ArrivalPlan {
+public:
+ static const size_t kCacheLineBytes = 64;
+
+/****************************************************************
+ * One hour of the plan: the voters that arrive in it, the second
+ * it starts and the rate per second of the gaps between arrivals.
+**/
+ struct Hour {
+   int voters = 0;
+   int start_seconds = 0;
+   double lambda = 0.0;
+ };
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ ArrivalPlan(const Configuration& config, int expected_voters);
+ ArrivalPlan(const ArrivalPlan&) = delete;
+ ArrivalPlan& operator=(const ArrivalPlan&) = delete;
+ virtual ~ArrivalPlan() = default;
+
+/****************************************************************
+ * Accessors. GetHour() is unchecked, as the loops over the hours
+ * that use it run from 0 to GetHoursCount().
+**/
+ int GetExpectedVoters() const;
+ const Hour& GetHour(int hour) const;
+ int GetHoursCount() const;
+ int GetVotersAtZero() const;
+ int GetVotersCount() const;
+
+/****************************************************************
+ * General functions. Fits() says whether the plan is the one for
+ * 'config' and 'expected_voters'. For() returns the shared plan
+ * for them; it may be called from any thread.
+**/
+ bool Fits(const Configuration& config, int expected_voters) const;
+ static shared_ptr<const ArrivalPlan> For(const Configuration& config,
+                                          int expected_voters);
+
+private:
+ int expected_voters_ = 0;
+ int hours_count_ = 0;
+ int voters_at_zero_ = 0;
+ int voters_count_ = 0;
+ double arrival_zero_ = 0.0;
+ vector<double> arrival_fractions_;
+ unique_ptr<char[]> memory_;
+ Hour* hours_ = nullptr;
+
+ static mutex plans_mutex_;
+ static map<pair<int, vector<double> >,
+            weak_ptr<const ArrivalPlan> > plans_;
+};
+
+static_assert(sizeof(ArrivalPlan::Hour) == 16,
+              "ArrivalPlan::Hour should pack into 16 bytes");
+
+#endif // ARRIVALPLAN_H
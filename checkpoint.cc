@@ -0,0 +1,250 @@
+#include "checkpoint.h"
+/****************************************************************
+ * Implementation for the 'Checkpoint' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#include <iomanip>
+#include <sstream>
+
+static const string kTag = "CHECKPOINT: ";
+
+/****************************************************************
+ * Function: ToStringHeader
+ * Returns the first line of a checkpoint for a run, newline and all.
+**/
+static string ToStringHeader(unsigned long long run_key) {
+  ostringstream outstream;
+  outstream << "CHECKPOINT " << hex << setw(16) << setfill('0') << run_key
+            << "\n";
+  return outstream.str();
+}
+
+/****************************************************************
+ * Function: ReadLines
+ * Reads 'line_count' lines of output, each with its level, into
+ * 'output'. Returns false if the file ends or is garbled first.
+**/
+static bool ReadLines(ifstream& in, int line_count, BufferSink& output) {
+  for (int sub = 0; sub < line_count; ++sub) {
+    string line = "";
+    int level = -1;
+    long long byte_count = -1;
+    if (!getline(in, line))
+      return false;
+    istringstream instream(line);
+    instream >> level >> byte_count;
+    if (!instream || (level < OutputSink::kSummary) ||
+        (level > OutputSink::kVoters) || (byte_count < 0))
+      return false;
+    string bytes(static_cast<size_t>(byte_count), '\0');
+    if ((byte_count > 0) && !in.read(&bytes[0], byte_count))
+      return false;
+    output.Output(bytes, level);
+  }
+  return true;
+}
+
+/****************************************************************
+ * Destructor.
+**/
+Checkpoint::~Checkpoint() {
+  this->Close();
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetRandomState
+ * Returns the generator state saved with the restored precincts,
+ * '-' if the run does not use a shared generator, or "" if
+ * nothing was restored.
+**/
+string Checkpoint::GetRandomState() const {
+  return random_state_;
+}
+
+/****************************************************************
+ * Function GetRestoredCount
+ * Returns the number of precincts read back by Open().
+**/
+int Checkpoint::GetRestoredCount() const {
+  return static_cast<int>(restored_pcts_.size());
+}
+
+/****************************************************************
+ * Function IsOpen
+ * Returns true once Open() has been called.
+**/
+bool Checkpoint::IsOpen() const {
+  return stream_.is_open();
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Close
+ * Closes the file if it is open.
+**/
+void Checkpoint::Close() {
+  if (stream_.is_open())
+    stream_.close();
+}
+
+/****************************************************************
+ * Function Mark
+ * Appends the state after 'pct_count' precincts and flushes, so
+ * everything up to here survives the run dying.
+**/
+void Checkpoint::Mark(int pct_count, const string& random_state) {
+  stream_ << "STATE " << pct_count << " " << random_state << "\n";
+  stream_.flush();
+}
+
+/****************************************************************
+ * Function Open
+ * Reads back the precincts saved up to the last state by a run
+ * with the same key, then rewrites the file with just those, so
+ * a torn entry at the end cannot get in the way of new ones.
+**/
+void Checkpoint::Open(const string& filename, unsigned long long run_key) {
+  string header = ToStringHeader(run_key);
+  vector<int> pending_pcts;
+  vector<BufferSink> pending_outputs;
+  vector<string> pending_records;
+
+  ifstream in(filename.c_str(), ios::binary);
+  string line = "";
+  if (in && getline(in, line) && (line + "\n" == header)) {
+    while (getline(in, line)) {
+      istringstream instream(line);
+      string tag = "";
+      instream >> tag;
+      if ("PCT" == tag) {
+        int pct_number = 0;
+        int line_count = -1;
+        string record = "";
+        instream >> pct_number >> line_count;
+        getline(instream >> ws, record);
+        if (!instream || (line_count < 0) || record.empty())
+          break;
+        BufferSink output;
+        if (!ReadLines(in, line_count, output))
+          break;
+        pending_pcts.push_back(pct_number);
+        pending_outputs.push_back(output);
+        pending_records.push_back(("-" == record) ? "" : record);
+      }
+      else if ("STATE" == tag) {
+        int pct_count = 0;
+        string state = "";
+        instream >> pct_count;
+        getline(instream >> ws, state);
+        if (!instream || state.empty() ||
+            (pct_count != this->GetRestoredCount()
+                          + static_cast<int>(pending_pcts.size())))
+          break;
+        restored_pcts_.insert(restored_pcts_.end(), pending_pcts.begin(),
+                              pending_pcts.end());
+        restored_outputs_.insert(restored_outputs_.end(),
+                                 pending_outputs.begin(),
+                                 pending_outputs.end());
+        restored_records_.insert(restored_records_.end(),
+                                 pending_records.begin(),
+                                 pending_records.end());
+        pending_pcts.clear();
+        pending_outputs.clear();
+        pending_records.clear();
+        random_state_ = state;
+      }
+      else {
+        break;
+      }
+    }
+  }
+  in.close();
+
+  stream_.open(filename.c_str(), ios::binary | ios::trunc);
+  if (!stream_) {
+    Utils::log_stream << kTag << "ERROR cannot open checkpoint file '"
+                      << filename << "'" << endl;
+    cout << kTag << "ERROR cannot open checkpoint file '" << filename << "'"
+         << endl;
+    exit(1);
+  }
+  stream_ << header;
+  for (int sub = 0; sub < this->GetRestoredCount(); ++sub) {
+    this->WriteEntry(restored_pcts_[sub], restored_outputs_[sub],
+                     restored_records_[sub]);
+  }
+  if (this->GetRestoredCount() > 0)
+    this->Mark(this->GetRestoredCount(), random_state_);
+  stream_.flush();
+}
+
+/****************************************************************
+ * Function Record
+ * Appends a finished precinct, the lines the run wrote for it and
+ * its result record, or "" if it has none to save.
+**/
+void Checkpoint::Record(int pct_number, const BufferSink& output,
+                        const string& record) {
+  this->WriteEntry(pct_number, output, record);
+  ++recorded_count_;
+}
+
+/****************************************************************
+ * Function Restore
+ * Sets 'output' and 'record' to what was saved for the precinct
+ * at 'index' and returns true, or returns false if that far was
+ * not saved. A different precinct at 'index' means the precinct
+ * file changed since the checkpoint was made, and nothing after
+ * it can be trusted, so the run stops.
+**/
+bool Checkpoint::Restore(int index, int pct_number, BufferSink& output,
+                         string& record) const {
+  if (index >= this->GetRestoredCount())
+    return false;
+  if (restored_pcts_[index] != pct_number) {
+    cout << kTag << "ERROR precinct " << pct_number << " is number "
+         << index + 1 << " in this run but the checkpoint has precinct "
+         << restored_pcts_[index] << "; remove the checkpoint file"
+         << endl;
+    exit(1);
+  }
+  output = restored_outputs_[index];
+  record = restored_records_[index];
+  return true;
+}
+
+/****************************************************************
+ * Function ToString
+ * Returns how many precincts the checkpoint holds, restored and
+ * recorded together, which is the same however often the run was
+ * restarted.
+**/
+string Checkpoint::ToString() const {
+  string s = "precincts saved "
+           + Utils::Format(this->GetRestoredCount() + recorded_count_, 6);
+  return s;
+}
+
+/****************************************************************
+ * Function WriteEntry
+ * Appends the entry of one precinct.
+**/
+void Checkpoint::WriteEntry(int pct_number, const BufferSink& output,
+                            const string& record) {
+  const vector<pair<int, string> >& lines = output.GetLines();
+  stream_ << "PCT " << pct_number << " " << lines.size() << " "
+          << (record.empty() ? "-" : record) << "\n";
+  for (auto iter = lines.begin(); iter != lines.end(); ++iter) {
+    stream_ << iter->first << " " << iter->second.size() << "\n"
+            << iter->second;
+  }
+}
@@ -0,0 +1,99 @@
+/****************************************************************
+ * Header for the 'Checkpoint' class.
+ *
+ * A Checkpoint lets a long batch run that dies partway be started
+ * again without redoing the precincts it had finished. As each
+ * precinct is finished, the run appends what it wrote for that
+ * precinct, each line with its level; every so often it also appends the state of the
+ * shared RN generator and flushes the file. A restarted run with
+ * the same configuration reads the file back, writes the saved
+ * output of the precincts finished before the last saved state
+ * instead of simulating them, puts the generator back in that
+ * state, and carries on, so its output is byte for byte that of
+ * a run that never stopped. A precinct that drew from a stream of
+ * its own also has its result record saved, which the restarted
+ * run puts through the memo table as the first run did, so the
+ * memo counts and the precincts that reuse the result are the
+ * same too. What is not saved, the queue series, voter traces and
+ * wall times, and the result cache, which is appended to past the
+ * last saved state, cannot be used with a checkpoint.
+ *
+ * The file is text. The first line names the run:
+ *   CHECKPOINT <16 hex digits>
+ * and then come precinct entries and states:
+ *   PCT <pct number> <line count> <PctResult record or '-'>
+ * followed, for each line of output, by
+ *   <OutputSink level> <byte count>
+ *   <that many bytes of output>
+ *   STATE <precincts so far> <MyRandom::ToStringState() or '-'>
+ * Anything after the last STATE line, such as a precinct cut short
+ * by a crash, is dropped when the file is reopened. A file for a
+ * different run is replaced.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "outputsink.h"
+
+class Checkpoint {
+public:
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ Checkpoint() = default;
+ virtual ~Checkpoint();
+
+/****************************************************************
+ * Accessors.
+**/
+ int GetRestoredCount() const;
+ string GetRandomState() const;
+ bool IsOpen() const;
+
+/****************************************************************
+ * General functions. Open() reads what an earlier run with the
+ * same 'run_key' saved and keeps the file open to add to.
+ * Restore() gives the saved output and result record, "" if none
+ * was saved, for the precinct at 'index' in the run's order, if it
+ * was saved; it exits if the saved precinct there is a different
+ * one. Record() appends a finished precinct and Mark() appends a
+ * state and flushes.
+**/
+ void Close();
+ void Mark(int pct_count, const string& random_state);
+ void Open(const string& filename, unsigned long long run_key);
+ void Record(int pct_number, const BufferSink& output,
+             const string& record);
+ bool Restore(int index, int pct_number, BufferSink& output,
+              string& record) const;
+ string ToString() const;
+
+private:
+ int recorded_count_ = 0;
+ string random_state_ = "";
+ vector<int> restored_pcts_;
+ vector<BufferSink> restored_outputs_;
+ vector<string> restored_records_;
+ ofstream stream_;
+
+/****************************************************************
+ * Private functions.
+**/
+ void WriteEntry(int pct_number, const BufferSink& output,
+                 const string& record);
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,279 @@
+#include "compressedfile.h"
+/****************************************************************
+ * Implementation for the 'CompressedFile' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * gzip is written with zlib's deflate, asked for a gzip header
+ * and trailer (window bits 15 + 16), and a Z_SYNC_FLUSH at the end
+ * of each block; zstd with ZSTD_compressStream2() and ZSTD_e_flush.
+ * Either way the codec's state lives in context_, which only the
+ * worker thread touches once Attach() has made it.
+ *
+**/
+
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static const string kTag = "COMPRESS: ";
+
+/****************************************************************
+ * Function: CompressError
+ * Reports that the compressor failed and stops.
+**/
+static void CompressError(const string& codec, const string& message) {
+  cout << kTag << "ERROR " << codec << ": " << message << endl;
+  exit(1);
+}
+
+/****************************************************************
+ * Destructor.
+**/
+CompressedFile::~CompressedFile() {
+  this->Finish();
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetBytesIn
+ * Returns the number of bytes written to the stream so far.
+**/
+long long CompressedFile::GetBytesIn() const {
+  lock_guard<mutex> lock(mutex_);
+  return bytes_in_ + (pptr() - pbase());
+}
+
+/****************************************************************
+ * Function GetBytesOut
+ * Returns the number of compressed bytes written to the file.
+**/
+long long CompressedFile::GetBytesOut() const {
+  lock_guard<mutex> lock(mutex_);
+  return bytes_out_;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Attach
+ * Sets up the codec, puts this in place of the stream's file
+ * buffer and starts the worker thread.
+**/
+void CompressedFile::Attach(ofstream& stream, const string& codec,
+                            int level) {
+  if (!HasCodec(codec))
+    CompressError(codec, "not a codec this build can write");
+  codec_ = codec;
+  level_ = level;
+
+  if ("gzip" == codec_) {
+    z_stream* zip = new z_stream();
+    int zip_level = (0 == level_) ? Z_DEFAULT_COMPRESSION : level_;
+    if (Z_OK != deflateInit2(zip, zip_level, Z_DEFLATED, 15 + 16, 8,
+                             Z_DEFAULT_STRATEGY)) {
+      CompressError(codec_, "cannot start deflate");
+    }
+    context_ = zip;
+  }
+#ifdef HAVE_ZSTD
+  else {
+    ZSTD_CCtx* zstd = ZSTD_createCCtx();
+    int zstd_level = (0 == level_) ? ZSTD_CLEVEL_DEFAULT : level_;
+    if ((nullptr == zstd) ||
+        ZSTD_isError(ZSTD_CCtx_setParameter(zstd, ZSTD_c_compressionLevel,
+                                            zstd_level))) {
+      CompressError(codec_, "cannot start the compressor");
+    }
+    context_ = zstd;
+  }
+#endif
+
+  stream_ = &stream;
+  file_ = stream.rdbuf();
+  block_.resize(kBlockBytes);
+  this->setp(block_.data(), block_.data() + block_.size());
+  stream.basic_ios<char>::rdbuf(this);
+  worker_ = thread(&CompressedFile::Work, this);
+}
+
+/****************************************************************
+ * Function Compress
+ * Compresses 'block' into the file, flushed so that everything
+ * so far can be decompressed, or, if it is the 'last', ending
+ * the compressed stream.
+**/
+void CompressedFile::Compress(const vector<char>& block, bool last) {
+  char out[1 << 16];
+  long long written = 0;
+  if ("gzip" == codec_) {
+    z_stream* zip = static_cast<z_stream*>(context_);
+    zip->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data()));
+    zip->avail_in = static_cast<uInt>(block.size());
+    do {
+      zip->next_out = reinterpret_cast<Bytef*>(out);
+      zip->avail_out = sizeof(out);
+      if (Z_STREAM_ERROR == deflate(zip, last ? Z_FINISH : Z_SYNC_FLUSH))
+        CompressError(codec_, "deflate failed");
+      size_t bytes = sizeof(out) - zip->avail_out;
+      file_->sputn(out, bytes);
+      written += bytes;
+    } while (0 == zip->avail_out);
+  }
+#ifdef HAVE_ZSTD
+  else {
+    ZSTD_CCtx* zstd = static_cast<ZSTD_CCtx*>(context_);
+    ZSTD_inBuffer in = { block.data(), block.size(), 0 };
+    size_t remaining = 0;
+    do {
+      ZSTD_outBuffer buffer = { out, sizeof(out), 0 };
+      remaining = ZSTD_compressStream2(zstd, &buffer, &in,
+                                       last ? ZSTD_e_end : ZSTD_e_flush);
+      if (ZSTD_isError(remaining))
+        CompressError(codec_, ZSTD_getErrorName(remaining));
+      file_->sputn(out, buffer.pos);
+      written += buffer.pos;
+    } while (0 != remaining);
+  }
+#endif
+
+  lock_guard<mutex> lock(mutex_);
+  bytes_out_ += written;
+}
+
+/****************************************************************
+ * Function Finish
+ * Compresses what is left, ends the compressed stream, waits for
+ * the worker and gives the stream back its file buffer.
+**/
+void CompressedFile::Finish() {
+  if (nullptr == stream_)
+    return;
+  this->HandOver();
+  {
+    lock_guard<mutex> lock(mutex_);
+    finishing_ = true;
+  }
+  queue_changed_.notify_all();
+  worker_.join();
+
+  if ("gzip" == codec_) {
+    z_stream* zip = static_cast<z_stream*>(context_);
+    deflateEnd(zip);
+    delete zip;
+  }
+#ifdef HAVE_ZSTD
+  else {
+    ZSTD_freeCCtx(static_cast<ZSTD_CCtx*>(context_));
+  }
+#endif
+  context_ = nullptr;
+
+  this->setp(nullptr, nullptr);
+  stream_->basic_ios<char>::rdbuf(file_);
+  file_->pubsync();
+  stream_ = nullptr;
+}
+
+/****************************************************************
+ * Function HandOver
+ * Queues the text gathered so far for the worker, first waiting
+ * for room in the queue, and starts a new block.
+**/
+void CompressedFile::HandOver() {
+  size_t bytes = pptr() - pbase();
+  if (0 == bytes)
+    return;
+  block_.resize(bytes);
+  {
+    unique_lock<mutex> lock(mutex_);
+    queue_changed_.wait(lock, [this] {
+      return queue_.size() < kBlocksQueued;
+    });
+    queue_.push_back(move(block_));
+    bytes_in_ += bytes;
+  }
+  queue_changed_.notify_all();
+
+  block_ = vector<char>(kBlockBytes);
+  this->setp(block_.data(), block_.data() + block_.size());
+}
+
+/****************************************************************
+ * Function HasCodec
+ * Returns true if this build can write 'codec'.
+**/
+bool CompressedFile::HasCodec(const string& codec) {
+  if ("gzip" == codec)
+    return true;
+#ifdef HAVE_ZSTD
+  if ("zstd" == codec)
+    return true;
+#endif
+  return false;
+}
+
+/****************************************************************
+ * Function MaxLevel
+ * Returns the highest level 'codec' takes.
+**/
+int CompressedFile::MaxLevel(const string& codec) {
+  if ("gzip" == codec)
+    return Z_BEST_COMPRESSION;
+#ifdef HAVE_ZSTD
+  if ("zstd" == codec)
+    return ZSTD_maxCLevel();
+#endif
+  return 0;
+}
+
+/****************************************************************
+ * Function overflow
+ * Called when the block is full: hands it over and puts
+ * 'character' at the start of the next.
+**/
+int CompressedFile::overflow(int character) {
+  this->HandOver();
+  if (traits_type::eq_int_type(character, traits_type::eof()))
+    return traits_type::not_eof(character);
+  *pptr() = traits_type::to_char_type(character);
+  this->pbump(1);
+  return character;
+}
+
+/****************************************************************
+ * Function sync
+ * Does nothing; a part block waits to be filled, see the header.
+**/
+int CompressedFile::sync() {
+  return 0;
+}
+
+/****************************************************************
+ * Function Work
+ * The worker thread: compresses the queued blocks in order until
+ * Finish() says there will be no more, then ends the stream.
+**/
+void CompressedFile::Work() {
+  vector<char> block;
+  while (true) {
+    {
+      unique_lock<mutex> lock(mutex_);
+      queue_changed_.wait(lock, [this] {
+        return !queue_.empty() || finishing_;
+      });
+      if (queue_.empty())
+        break;
+      block = move(queue_.front());
+      queue_.pop_front();
+    }
+    queue_changed_.notify_all();
+    this->Compress(block, false);
+  }
+  this->Compress(vector<char>(), true);
+}
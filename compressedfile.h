@@ -0,0 +1,98 @@
+/****************************************************************
+ * Header for the 'CompressedFile' class.
+ *
+ * A CompressedFile takes over the writing of an ofstream that is
+ * already open, so that everything the simulation writes to it,
+ * with << or Utils::Output, goes into the file compressed with
+ * gzip (zlib) or, in a build with HAVE_ZSTD defined, zstd.
+ *
+ * The text written is gathered in blocks of kBlockBytes. Each
+ * full block is handed to a thread of the CompressedFile's own,
+ * which compresses it and writes it to the file while the
+ * simulation goes on, with at most kBlocksQueued waiting. Every
+ * block is compressed with a flush at its end, so a reader can
+ * decompress the file as far as it has been written while the
+ * run is still going ('gzip -dc' or 'zstd -dc' on the partial
+ * file), at the cost of a few bytes a block. Flushing the stream
+ * does not hand over a part block, since Utils::Output flushes
+ * after every line and that would compress every line alone.
+ *
+ * Finish() compresses what is left, ends the compressed stream
+ * and gives the stream back its own file buffer, so it must be
+ * called before the stream is closed.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef COMPRESSEDFILE_H
+#define COMPRESSEDFILE_H
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+class CompressedFile : public streambuf {
+public:
+ static const size_t kBlockBytes = 1 << 18;
+ static const size_t kBlocksQueued = 4;
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ CompressedFile() = default;
+ virtual ~CompressedFile();
+
+/****************************************************************
+ * Accessors.
+**/
+ long long GetBytesIn() const;
+ long long GetBytesOut() const;
+
+/****************************************************************
+ * General functions. Attach() starts compressing what is written
+ * to 'stream' with 'codec', "gzip" or "zstd", at 'level', or the
+ * codec's default level if 'level' is 0. HasCodec() says whether
+ * this build can write a codec and MaxLevel() its highest level.
+**/
+ void Attach(ofstream& stream, const string& codec, int level);
+ void Finish();
+ static bool HasCodec(const string& codec);
+ static int MaxLevel(const string& codec);
+
+protected:
+ int overflow(int character) override;
+ int sync() override;
+
+private:
+ string codec_ = "";
+ int level_ = 0;
+ ofstream* stream_ = nullptr;
+ filebuf* file_ = nullptr;
+ void* context_ = nullptr;
+
+ vector<char> block_;
+ deque<vector<char> > queue_;
+ bool finishing_ = false;
+ long long bytes_in_ = 0;
+ long long bytes_out_ = 0;
+ mutable mutex mutex_;
+ condition_variable queue_changed_;
+ thread worker_;
+
+ void Compress(const vector<char>& block, bool last);
+ void HandOver();
+ void Work();
+};
+
+#endif // COMPRESSEDFILE_H
@@ -14,6 +14,13 @@
  *
  **/
 
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+
+#include "compressedfile.h"
+#include "outputsink.h"
+
 // File tag for output purposes. (Consider using __FILE__?)
 static const string kTag = "CONFIG: ";
 
@@ -28,9 +35,61 @@ int Configuration::GetMaxServiceSubscript() const {
   return static_cast<int>(actual_service_times_.size()) - 1;
 }
 
+/****************************************************************
+ * Function: GetModes
+ * Returns the options given that each replace the plain run with
+ * a run of their own, in the order main tries them.
+ **/
+vector<string> Configuration::GetModes() const {
+  vector<string> modes;
+  if (stream_window_ > 0)
+    modes.push_back("stream");
+  if (!serve_.empty())
+    modes.push_back("serve");
+  if (!sweep_filename_.empty())
+    modes.push_back("sweep");
+  if (!schedules_.empty())
+    modes.push_back("schedule");
+  if (budget_ > 0)
+    modes.push_back("budget");
+  if (arrivals_check_ > 0)
+    modes.push_back("arrivals_check");
+  if (kernel_bench_ > 0)
+    modes.push_back("kernel_bench");
+  if (surface_points_ > 0)
+    modes.push_back("surface");
+  return modes;
+}
+
 /****************************************************************
  * General functions.
  **/
+/****************************************************************
+ * Function: CheckLimits
+ * Stops the run if the configuration read will not fit in the
+ * packed OneVoter: the day must be between one hour and a year,
+ * so every time in it is well inside 32 bits, and every service
+ * time between zero and OneVoter::kMaxDurationSeconds.
+ **/
+void Configuration::CheckLimits() const {
+  if ((election_day_length_hours_ < 1) ||
+      (election_day_length_hours_ > kMaxElectionDayLengthHours)) {
+    cout << kTag << "ERROR election day of " << election_day_length_hours_
+         << " hours; it must be 1 to " << kMaxElectionDayLengthHours
+         << " hours" << endl;
+    exit(1);
+  }
+  for (int sub = 0; sub <= this->GetMaxServiceSubscript(); ++sub) {
+    int service_time = actual_service_times_[sub];
+    if ((service_time < 0) || (service_time > OneVoter::kMaxDurationSeconds)) {
+      cout << kTag << "ERROR service time " << service_time << " at number "
+           << sub + 1 << " in dataallsorted.txt; it must be 0 to "
+           << OneVoter::kMaxDurationSeconds << " seconds" << endl;
+      exit(1);
+    }
+  }
+}
+
 /****************************************************************
  **/
 /****************************************************************
@@ -121,6 +180,609 @@ void Configuration::ReadConfiguration(Scanner& instream) {
     int thetime = service_times_file.NextInt();
     actual_service_times_.push_back(thetime);
   }
+  this->CheckLimits();
+}
+
+/****************************************************************
+ * Function: ReadConfiguration
+ * Takes in a FastScanner
+ *
+ * Reads the same two lines as the Scanner version above, in the
+ * same order, and then the service times from dataallsorted.txt.
+ * As with ScanLine, extra fields at the end of either line are
+ * ignored, but a line that is short of fields is an error that
+ * names the line and column instead of silently reading the
+ * next line.
+ **/
+void Configuration::ReadConfiguration(FastScanner& instream) {
+  // Line one: seed, hours, mean time to vote, min and max expected
+  // voters, the 'too long' wait and the number of iterations.
+  int* line_one_fields[] = { &seed_, &election_day_length_hours_,
+                             &time_to_vote_mean_seconds_,
+                             &min_expected_to_simulate_,
+                             &max_expected_to_simulate_,
+                             &wait_time_minutes_that_is_too_long_,
+                             &number_of_iterations_ };
+  for (int* field : line_one_fields) {
+    if (!instream.HasNextOnLine())
+      instream.Error("configuration line 1 needs 7 integer fields");
+    *field = instream.NextInt();
+  }
+  election_day_length_seconds_ = election_day_length_hours_ * 3600;
+  instream.SkipLine();
+
+  // Line two: the percentage waiting at zero and one per hour.
+  if (!instream.HasNextOnLine())
+    instream.Error("configuration line 2 needs the arrival percentages");
+  arrival_zero_ = instream.NextDouble();
+  for (int sub = 0; sub < election_day_length_hours_; ++sub) {
+    if (!instream.HasNextOnLine())
+      instream.Error("configuration line 2 needs "
+                     + to_string(election_day_length_hours_)
+                     + " hourly arrival percentages");
+    arrival_fractions_.push_back(instream.NextDouble());
+  }
+  instream.SkipLine();
+
+  FastScanner service_times_file;
+  service_times_file.OpenFile("dataallsorted.txt");
+  while (service_times_file.HasNext()) {
+    actual_service_times_.push_back(service_times_file.NextInt());
+  }
+  service_times_file.Close();
+  this->CheckLimits();
+}
+
+/****************************************************************
+ * Function: OptionError
+ * Reports a bad run option and stops.
+ **/
+static void OptionError(const string& option, const string& message) {
+  cout << kTag << "ERROR option '" << option << "': " << message << endl;
+  exit(1);
+}
+
+/****************************************************************
+ * Function: OptionInt
+ * Returns the value of an integer option, which must be at least
+ * 'lowest'.
+ **/
+static int OptionInt(const string& option, const string& value, int lowest) {
+  char* parsed_to = nullptr;
+  long result = strtol(value.c_str(), &parsed_to, 10);
+  if (value.empty() || ('\0' != *parsed_to) || (result < lowest) ||
+      (result > INT_MAX)) {
+    OptionError(option, "needs an integer of at least "
+                        + to_string(lowest));
+  }
+  return static_cast<int>(result);
+}
+
+/****************************************************************
+ * Function: OptionIntList
+ * Returns the values of an option that is a comma-separated list
+ * of integers, each at least 'lowest'.
+ **/
+static vector<int> OptionIntList(const string& option, const string& value,
+                                 int lowest) {
+  vector<int> values;
+  size_t start = 0;
+  while (start <= value.size()) {
+    size_t comma = value.find(',', start);
+    if (string::npos == comma)
+      comma = value.size();
+    values.push_back(OptionInt(option, value.substr(start, comma - start),
+                               lowest));
+    start = comma + 1;
+  }
+  return values;
+}
+
+/****************************************************************
+ * Function: OptionBool
+ * Returns the value of an on/off option written 0 or 1.
+ **/
+static bool OptionBool(const string& option, const string& value) {
+  if (("0" != value) && ("1" != value))
+    OptionError(option, "needs 0 or 1");
+  return "1" == value;
+}
+
+/****************************************************************
+ * Function: OptionLevel
+ * Returns the value of an output level option, kSummary to kVoters.
+ **/
+static int OptionLevel(const string& option, const string& value) {
+  int level = OptionInt(option, value, OutputSink::kSummary);
+  if (level > OutputSink::kVoters)
+    OptionError(option, "needs 0, 1 or 2");
+  return level;
+}
+
+/****************************************************************
+ * Function: OptionMode
+ * Stops the run if an option was 'given' with a run 'mode' that
+ * would ignore it; 'modes' are those that honour it besides the
+ * plain run, whose mode is "".
+ **/
+static void OptionMode(const string& option, bool given, const string& mode,
+                       const set<string>& modes) {
+  if (given && !mode.empty() && (0 == modes.count(mode)))
+    OptionError(option, "cannot go with " + mode);
+}
+
+/****************************************************************
+ * Function: HasOption
+ * Returns true if an option 'name' was given on the command line.
+ **/
+bool Configuration::HasOption(const string& name) const {
+  for (auto iter = options_.begin(); iter != options_.end(); ++iter) {
+    if (0 == iter->compare(0, name.size() + 1, name + "="))
+      return true;
+  }
+  return false;
+}
+
+/****************************************************************
+ * Function: ReadOptions
+ * Takes the command line and the subscript of its first option.
+ *
+ * Every argument from 'first_option' on must be 'name=value'
+ * with a name listed in configuration.h. The options are kept
+ * in the order given so that ToString() can show them. This
+ * comes after ReadConfiguration(), since a schedule is checked
+ * against the length of the day.
+ **/
+void Configuration::ReadOptions(int argc, char *argv[], int first_option) {
+  for (int sub = first_option; sub < argc; ++sub) {
+    string option = static_cast<string>(argv[sub]);
+    size_t equals = option.find('=');
+    if (string::npos == equals)
+      OptionError(option, "options are written 'name=value'");
+    string name = option.substr(0, equals);
+    string value = option.substr(equals + 1);
+
+    if ("antithetic" == name) {
+      antithetic_ = OptionBool(option, value);
+    }
+    else if ("arrivals" == name) {
+      if (("chain" != value) && ("order" != value))
+        OptionError(option, "arrivals is 'chain' or 'order'");
+      arrivals_ = value;
+    }
+    else if ("arrivals_check" == name) {
+      arrivals_check_ = OptionInt(option, value, 1);
+    }
+    else if ("arena_stats" == name) {
+      arena_stats_ = OptionBool(option, value);
+    }
+    else if ("budget" == name) {
+      budget_ = OptionInt(option, value, 1);
+    }
+    else if ("compress" == name) {
+      if ("zstd" == value && !CompressedFile::HasCodec(value))
+        OptionError(option, "zstd needs a build with HAVE_ZSTD");
+      if (("0" != value) && !CompressedFile::HasCodec(value))
+        OptionError(option, "compress is 0, 'gzip' or 'zstd'");
+      compress_ = ("0" == value) ? "" : value;
+    }
+    else if ("compress_level" == name) {
+      compress_level_ = OptionInt(option, value, 1);
+    }
+    else if ("control" == name) {
+      control_variates_ = OptionBool(option, value);
+    }
+    else if ("kernels" == name) {
+      kernels_ = OptionBool(option, value);
+    }
+    else if ("kernel_bench" == name) {
+      kernel_bench_ = OptionInt(option, value, 1);
+    }
+    else if ("log_level" == name) {
+      log_level_ = OptionLevel(option, value);
+    }
+    else if ("out_level" == name) {
+      out_level_ = OptionLevel(option, value);
+    }
+    else if ("prescreen" == name) {
+      if (("0" != value) && ("1" != value) && ("verify" != value))
+        OptionError(option, "prescreen is 0, 1 or 'verify'");
+      prescreen_ = ("0" != value);
+      prescreen_verify_ = ("verify" == value);
+    }
+    else if ("rng" == name) {
+      if (("shared" != value) && ("precinct" != value) &&
+          ("workload" != value))
+        OptionError(option, "rng is 'shared', 'precinct' or 'workload'");
+      rng_streams_ = value;
+    }
+    else if ("cache" == name) {
+      if (value.empty())
+        OptionError(option, "needs a file name");
+      cache_filename_ = value;
+    }
+    else if ("checkpoint" == name) {
+      if (value.empty())
+        OptionError(option, "needs a file name");
+      checkpoint_filename_ = value;
+    }
+    else if ("checkpoint_every" == name) {
+      checkpoint_every_ = OptionInt(option, value, 1);
+    }
+    else if ("merge" == name) {
+      size_t start = 0;
+      while (start <= value.size()) {
+        size_t comma = value.find(',', start);
+        if (string::npos == comma)
+          comma = value.size();
+        if (comma == start)
+          OptionError(option, "needs shard cache file names");
+        merge_filenames_.push_back(value.substr(start, comma - start));
+        start = comma + 1;
+      }
+    }
+    else if ("shard" == name) {
+      size_t slash = value.find('/');
+      if (string::npos == slash)
+        OptionError(option, "is written shard=K/N");
+      shard_index_ = OptionInt(option, value.substr(0, slash), 1);
+      shard_count_ = OptionInt(option, value.substr(slash + 1), 1);
+      if (shard_index_ > shard_count_)
+        OptionError(option, "needs K from 1 to N");
+    }
+    else if ("series" == name) {
+      if (value.empty())
+        OptionError(option, "needs a file name");
+      series_filename_ = value;
+    }
+    else if ("trace" == name) {
+      if (value.empty())
+        OptionError(option, "needs a file name");
+      trace_filename_ = value;
+    }
+    else if ("serve" == name) {
+      if (value.empty())
+        OptionError(option, "needs 'stdin' or a socket path");
+      serve_ = value;
+    }
+    else if ("stream" == name) {
+      stream_window_ = OptionInt(option, value, 1);
+    }
+    else if ("schedule" == name) {
+      vector<int> schedule = OptionIntList(option, value, 1);
+      if (static_cast<int>(schedule.size()) != election_day_length_hours_)
+        OptionError(option, "needs one station count for each of the "
+                            + to_string(election_day_length_hours_) + " hours");
+      for (int count : schedule) {
+        if (count > OneVoter::kMaxStationCount)
+          OptionError(option, "station counts must be at most "
+                              + to_string(OneVoter::kMaxStationCount));
+      }
+      schedules_.push_back(schedule);
+    }
+    else if ("surface" == name) {
+      surface_points_ = OptionInt(option, value, 2);
+    }
+    else if ("surface_checks" == name) {
+      surface_checks_ = OptionInt(option, value, 0);
+    }
+    else if ("toolong_sweep" == name) {
+      toolong_sweep_ = OptionIntList(option, value, 0);
+    }
+    else if ("sweep" == name) {
+      if (value.empty())
+        OptionError(option, "needs a file name");
+      sweep_filename_ = value;
+    }
+    else if ("threads" == name) {
+      thread_count_ = OptionInt(option, value, 1);
+    }
+    else if ("time_budget_ms" == name) {
+      time_budget_ms_ = OptionInt(option, value, 1);
+    }
+    else if ("timing" == name) {
+      timing_ = OptionBool(option, value);
+    }
+    else {
+      OptionError(option, "unknown option");
+    }
+    options_.push_back(option);
+  }
+
+  // A result that depends on what earlier precincts drew from a
+  // shared stream cannot be reused for a different run.
+  if (!cache_filename_.empty() && this->UsesSharedRandom())
+    OptionError("cache=" + cache_filename_,
+                "needs rng=precinct or rng=workload");
+
+  if (compress_level_ > 0) {
+    string option = "compress_level=" + to_string(compress_level_);
+    if (compress_.empty())
+      OptionError(option, "needs compress=gzip or compress=zstd");
+    if (compress_level_ > CompressedFile::MaxLevel(compress_))
+      OptionError(option, "needs a level of at most "
+                          + to_string(CompressedFile::MaxLevel(compress_))
+                          + " for " + compress_);
+  }
+
+  // main runs the first mode it finds and would drop the rest.
+  vector<string> modes = this->GetModes();
+  if (modes.size() > 1)
+    OptionError(modes.at(1), "cannot go with " + modes.at(0));
+  string mode = modes.empty() ? "" : modes.at(0);
+
+  // Caches, shard results, series, traces, toolong sweeps and
+  // timing are all done by SimulatePct, which only the plain and
+  // streamed runs go through; the budget keeps its curves in the
+  // cache as well.
+  OptionMode("cache", !cache_filename_.empty(), mode, {"stream", "budget"});
+  OptionMode("merge", !merge_filenames_.empty(), mode, {"stream"});
+  OptionMode("series", !series_filename_.empty(), mode, {"stream"});
+  OptionMode("trace", !trace_filename_.empty(), mode, {"stream"});
+  OptionMode("toolong_sweep", !toolong_sweep_.empty(), mode, {"stream"});
+  OptionMode("timing", timing_, mode, {"stream"});
+  OptionMode("time_budget_ms", time_budget_ms_ > 0, mode, {"stream"});
+
+  // The plain run does its precincts one after another, and so
+  // does a streamed run whose precincts share one RN stream.
+  if (thread_count_ > 1) {
+    string option = "threads=" + to_string(thread_count_);
+    if (mode.empty())
+      OptionError(option, "needs stream, sweep, serve, surface or budget");
+    OptionMode(option, true, mode,
+               {"stream", "sweep", "serve", "surface", "budget"});
+    if (("stream" == mode) && this->UsesSharedRandom())
+      OptionError(option, "with stream needs rng=precinct or rng=workload");
+  }
+
+  // These only tune the option they go with.
+  if (this->HasOption("checkpoint_every") && checkpoint_filename_.empty())
+    OptionError("checkpoint_every", "needs checkpoint=FILE");
+  if (this->HasOption("surface_checks") && ("surface" != mode))
+    OptionError("surface_checks", "needs surface=N");
+
+  // A checkpoint keeps each precinct's output, and its result,
+  // but not its series, trace or wall time; the cache file
+  // is appended to past the last saved state, so a restarted run
+  // would find the precincts it lost there and count them as hits;
+  // and restored results have no arena figures for the memo table
+  // to hand on.
+  if (!checkpoint_filename_.empty()) {
+    OptionMode("checkpoint", true, mode, {});
+    if (!cache_filename_.empty() || !series_filename_.empty() ||
+        !trace_filename_.empty() || timing_ || (time_budget_ms_ > 0))
+      OptionError("checkpoint", "cannot go with cache, series, trace, "
+                                "timing or time_budget_ms");
+    if (arena_stats_ && ("workload" == rng_streams_))
+      OptionError("checkpoint", "cannot go with arena_stats and "
+                                "rng=workload");
+  }
+
+  // A schedule makes one set of voters a day, not pairs, and has
+  // no control variates to adjust by.
+  OptionMode("antithetic", antithetic_ && ("schedule" == mode), mode, {});
+  OptionMode("control", control_variates_ && ("schedule" == mode), mode, {});
+
+  // A screened station count has no waits to rescore.
+  if (prescreen_ && !toolong_sweep_.empty())
+    OptionError("prescreen", "cannot go with toolong_sweep");
+
+  // Shards are simulated apart and merged by their results, so
+  // each precinct must draw the same numbers in any shard, and
+  // the results must be ones a cache file can hold. Only the plain
+  // run deals out the shard's precincts.
+  if (shard_count_ > 0) {
+    string option = "shard=" + to_string(shard_index_) + "/"
+                  + to_string(shard_count_);
+    OptionMode(option, true, mode, {});
+    if (this->UsesSharedRandom() || cache_filename_.empty())
+      OptionError(option, "needs rng=precinct or rng=workload and cache=FILE");
+    if (!merge_filenames_.empty() || !toolong_sweep_.empty())
+      OptionError(option, "cannot go with merge or toolong_sweep");
+  }
+  if (!merge_filenames_.empty()) {
+    if (this->UsesSharedRandom() || !toolong_sweep_.empty())
+      OptionError("merge", "needs rng=precinct or rng=workload and cannot "
+                           "go with toolong_sweep");
+  }
+}
+
+/****************************************************************
+ * Function: ReadSweepSpec
+ * Takes a scanner on a sweep spec file.
+ *
+ * The first word of the spec is 'product' or 'list'; '#' starts
+ * a comment that runs to the end of its line. In a product spec
+ * each line is one field with its values separated by ';', and
+ * every combination of one value per line is a configuration,
+ * the first line's values changing slowest:
+ *   product
+ *   seed=19;20;21
+ *   mean=105;120
+ * In a list spec each line is one configuration, the fields it
+ * changes written as options are:
+ *   list
+ *   seed=19 mean=105
+ *   seed=20 arrivals=0,10,10,10,5,5,5,10,10,5,5,5,10,10
+ * The fields are those SetSweepField() knows.
+ **/
+vector<Configuration> Configuration::ReadSweepSpec(FastScanner& spec) const {
+  vector<Configuration> configs;
+  string kind = "";
+
+  while (spec.HasNext()) {
+    string token = spec.Next();
+    if ('#' == token[0]) {
+      spec.SkipLine();
+      continue;
+    }
+    if (kind.empty()) {
+      if (("product" != token) && ("list" != token))
+        spec.Error("a sweep spec starts with 'product' or 'list'");
+      kind = token;
+      configs.push_back(*this);
+      spec.SkipLine();
+      continue;
+    }
+
+    // One line: the fields of one configuration or one axis.
+    vector<string> fields;
+    fields.push_back(token);
+    while (spec.HasNextOnLine()) {
+      token = spec.Next();
+      if ('#' == token[0])
+        break;
+      fields.push_back(token);
+    }
+    spec.SkipLine();
+
+    if ("list" == kind) {
+      Configuration config = *this;
+      for (auto iter = fields.begin(); iter != fields.end(); ++iter) {
+        size_t equals = iter->find('=');
+        if (string::npos == equals)
+          OptionError(*iter, "sweep fields are written 'name=value'");
+        config.SetSweepField(iter->substr(0, equals), iter->substr(equals + 1));
+        config.sweep_label_ += (config.sweep_label_.empty() ? "" : " ") + *iter;
+      }
+      configs.push_back(config);
+      continue;
+    }
+
+    if (1 != fields.size())
+      spec.Error("a product line is one field, 'name=value;value;...'");
+    size_t equals = fields.at(0).find('=');
+    if (string::npos == equals)
+      OptionError(fields.at(0), "sweep fields are written 'name=value'");
+    string name = fields.at(0).substr(0, equals);
+    string values = fields.at(0).substr(equals + 1);
+
+    vector<Configuration> product;
+    for (auto config = configs.begin(); config != configs.end(); ++config) {
+      size_t start = 0;
+      while (start <= values.size()) {
+        size_t semicolon = values.find(';', start);
+        if (string::npos == semicolon)
+          semicolon = values.size();
+        string value = values.substr(start, semicolon - start);
+        Configuration combined = *config;
+        combined.SetSweepField(name, value);
+        combined.sweep_label_ += (combined.sweep_label_.empty() ? "" : " ")
+                               + name + "=" + value;
+        product.push_back(combined);
+        start = semicolon + 1;
+      }
+    }
+    configs = product;
+  }
+
+  // A list spec starts from nothing; the copy pushed above was
+  // only there to seed a product.
+  if ("list" == kind)
+    configs.erase(configs.begin());
+  if (kind.empty() || configs.empty())
+    spec.Error("a sweep spec needs at least one configuration");
+  return configs;
+}
+
+/****************************************************************
+ * Function: SetSweepField
+ * Sets one field of the configuration from a sweep spec: 'seed',
+ * 'mean' (time to vote), 'toolong' (minutes), 'iterations', or
+ * 'arrivals', which is the percentage waiting at zero and then
+ * one percentage per hour, separated by commas.
+ **/
+void Configuration::SetSweepField(const string& name, const string& value) {
+  string option = name + "=" + value;
+  if ("seed" == name) {
+    seed_ = OptionInt(option, value, 0);
+  }
+  else if ("mean" == name) {
+    time_to_vote_mean_seconds_ = OptionInt(option, value, 1);
+  }
+  else if ("toolong" == name) {
+    wait_time_minutes_that_is_too_long_ = OptionInt(option, value, 0);
+  }
+  else if ("iterations" == name) {
+    number_of_iterations_ = OptionInt(option, value, 1);
+  }
+  else if ("arrivals" == name) {
+    vector<double> percents;
+    size_t start = 0;
+    while (start <= value.size()) {
+      size_t comma = value.find(',', start);
+      if (string::npos == comma)
+        comma = value.size();
+      string field = value.substr(start, comma - start);
+      char* parsed_to = nullptr;
+      double percent = strtod(field.c_str(), &parsed_to);
+      if (field.empty() || ('\0' != *parsed_to) || (percent < 0.0))
+        OptionError(option, "needs percentages that are numbers");
+      percents.push_back(percent);
+      start = comma + 1;
+    }
+    if (static_cast<int>(percents.size()) != election_day_length_hours_ + 1)
+      OptionError(option, "needs the percentage at zero and one for each of "
+                          + to_string(election_day_length_hours_) + " hours");
+    arrival_zero_ = percents.at(0);
+    arrival_fractions_.assign(percents.begin() + 1, percents.end());
+  }
+  else {
+    OptionError(option, "a sweep field is seed, mean, toolong, iterations "
+                        "or arrivals");
+  }
+}
+
+/****************************************************************
+ * Function: UsesSharedRandom
+ * Returns true if every precinct draws from the one RN stream
+ * passed down from main, in which case precincts must be
+ * simulated one after another in precinct order.
+ **/
+bool Configuration::UsesSharedRandom() const {
+  return "shared" == rng_streams_;
+}
+
+/****************************************************************
+ * Function: WantsVoters
+ * Returns true if the out or log file is to have every voter.
+ **/
+bool Configuration::WantsVoters() const {
+  return (out_level_ >= OutputSink::kVoters) ||
+         (log_level_ >= OutputSink::kVoters);
+}
+
+/****************************************************************
+ * Function: ToStringSimulationInputs
+ * Returns the fields that a precinct's simulation result depends
+ * on, written exactly. The min and max expected voters are left
+ * out because they only choose which precincts are simulated,
+ * and the service times are left to the caller, who will want a
+ * digest of them rather than all of them. Antithetic pairing
+ * changes the draws, so it is part of the inputs; control
+ * variates only change the report, so they are not.
+ **/
+string Configuration::ToStringSimulationInputs() const {
+  char buffer[32];
+  string s = "seed " + to_string(seed_)
+           + " hours " + to_string(election_day_length_hours_)
+           + " mean " + to_string(time_to_vote_mean_seconds_)
+           + " toolong " + to_string(wait_time_minutes_that_is_too_long_)
+           + " iterations " + to_string(number_of_iterations_);
+  snprintf(buffer, sizeof(buffer), "%.17g", arrival_zero_);
+  s += " arrivals " + static_cast<string>(buffer);
+  for (auto iter = arrival_fractions_.begin();
+            iter != arrival_fractions_.end(); ++iter) {
+    snprintf(buffer, sizeof(buffer), "%.17g", *iter);
+    s += " " + static_cast<string>(buffer);
+  }
+  if (antithetic_)
+    s += " antithetic";
+  if ("chain" != arrivals_)
+    s += " arrivals " + arrivals_;
+  if (prescreen_)
+    s += " prescreen";
+  return s;
 }
 
 /****************************************************************
@@ -129,38 +791,37 @@ void Configuration::ReadConfiguration(Scanner& instream) {
  **/
 string Configuration::ToString()
 {
-  string s = "\n";
-  s += kTag;
-  s += "RN seed:              ";
-  s += Utils::Format(seed_, 8) + "\n";
-  s += kTag;
-  s += "Election Day length:  ";
-  s += Utils::Format(election_day_length_seconds_, 8) + " =";
-  s += Utils::Format(election_day_length_seconds_/3600.0, 8, 2) + " (";
-  s += Utils::Format(election_day_length_hours_, 8, 2) + ") hours\n";
-  s += kTag;
-  s += "Time to vote mean:    ";
-  s += Utils::Format(time_to_vote_mean_seconds_, 8) + " =";
-  s += Utils::Format(time_to_vote_mean_seconds_/60.0, 8, 2) + " minutes\n";
-  s += kTag;
-  s += "Min and max expected voters for this simulation:     ";
-  s += Utils::Format(min_expected_to_simulate_, 8);
-  s += Utils::Format(max_expected_to_simulate_, 8) + "\n";
-  s += "Wait time (minutes) that is 'too long': ";
-  s += Utils::Format(wait_time_minutes_that_is_too_long_, 8) + "\n";
-  s += "Number of iterations to perform: ";
-  s += Utils::Format(number_of_iterations_, 4) + "\n";
-  s += "Max service time subscript: ";
-  s += Utils::Format(GetMaxServiceSubscript(), 6) + "\n";
+  LineFormat line;
+  line.Add("\n");
+  line.Add(kTag).Add("RN seed:              ").Add(seed_, 8).Add("\n");
+  line.Add(kTag).Add("Election Day length:  ")
+      .Add(election_day_length_seconds_, 8).Add(" =")
+      .Add(election_day_length_seconds_/3600.0, 8, 2).Add(" (")
+      .Add(static_cast<double>(election_day_length_hours_), 8, 2)
+      .Add(") hours\n");
+  line.Add(kTag).Add("Time to vote mean:    ")
+      .Add(time_to_vote_mean_seconds_, 8).Add(" =")
+      .Add(time_to_vote_mean_seconds_/60.0, 8, 2).Add(" minutes\n");
+  line.Add(kTag).Add("Min and max expected voters for this simulation:     ")
+      .Add(min_expected_to_simulate_, 8).Add(max_expected_to_simulate_, 8)
+      .Add("\n");
+  line.Add("Wait time (minutes) that is 'too long': ")
+      .Add(wait_time_minutes_that_is_too_long_, 8).Add("\n");
+  line.Add("Number of iterations to perform: ")
+      .Add(number_of_iterations_, 4).Add("\n");
+  line.Add("Max service time subscript: ")
+      .Add(GetMaxServiceSubscript(), 6).Add("\n");
   int offset = 6;
-  s += kTag;
-  s += Utils::Format(0, 2) + "-" + Utils::Format(0, 2);
-  s += " : " + Utils::Format(arrival_zero_, 7, 2) + "\n";
+  line.Add(kTag).Add(0, 2).Add("-").Add(0, 2)
+      .Add(" : ").Add(arrival_zero_, 7, 2).Add("\n");
   for (UINT sub = 0; sub < arrival_fractions_.size(); ++sub) {
-    s += kTag;
-    s += Utils::Format(offset+sub, 2) + "-" + Utils::Format(offset+sub+1, 2);
-    s += " : " + Utils::Format(arrival_fractions_.at(sub), 7, 2) + "\n";
+    line.Add(kTag).Add(static_cast<int>(offset+sub), 2).Add("-")
+        .Add(static_cast<int>(offset+sub+1), 2)
+        .Add(" : ").Add(arrival_fractions_.at(sub), 7, 2).Add("\n");
   }
-  s += "\n";
-  return s;
+  for (UINT sub = 0; sub < options_.size(); ++sub) {
+    line.Add(kTag).Add("option ").Add(options_.at(sub)).Add("\n");
+  }
+  line.Add("\n");
+  return line.ToString();
 }
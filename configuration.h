@@ -22,12 +22,16 @@
 #include "../Utilities/scanner.h"
 #include "../Utilities/scanline.h"
 
+#include "fastscanner.h"
+#include "lineformat.h"
 #include "myrandom.h"
+#include "onevoter.h"
 
 using namespace std;
 
 static const int kDefaultSeed = 19;
 static const int kDummyConfigInt = -111;
+static const int kMaxElectionDayLengthHours = 24 * 365;
 static const double kDummyConfigDouble = -22.22;
 
 class Configuration
@@ -54,18 +58,200 @@ class Configuration
   double arrival_zero_ = kDummyConfigDouble;
   vector<double> arrival_fractions_;
 
+  /****************************************************************
+   * Run options, given on the command line after the four file
+   * names as 'name=value'. The defaults reproduce a plain run.
+   * At most one of stream, serve, sweep, schedule, budget,
+   * arrivals_check, kernel_bench and surface, which each replace
+   * the plain run, may be given. Options a run would ignore are
+   * refused: cache, merge, series, trace, toolong_sweep, timing
+   * and time_budget_ms go only with a plain or streamed run (cache
+   * also with budget), and antithetic and control not with
+   * schedule.
+   *   rng=shared|precinct|workload
+   *                        one RN stream for the whole run, or an
+   *                        independent stream per precinct number,
+   *                        or one per precinct workload, so that
+   *                        precincts with the same expected voters
+   *                        and histogram stations share one result
+   *   series=FILE          record each precinct's queue length, voters
+   *                        in service and station use minute by minute,
+   *                        write them to FILE as CSV and report them
+   *                        hour by hour
+   *   serve=stdin|PATH     keep the precincts in memory and answer
+   *                        what-if queries (see queryserver.h) read
+   *                        from stdin or from a Unix domain socket
+   *   stream=N             read, simulate and write the precincts
+   *                        one at a time with at most N in flight
+   *   sweep=FILE           run every configuration of the sweep spec
+   *                        in FILE, see ReadSweepSpec(), on the same
+   *                        precincts and service times
+   *   threads=N            worker threads for the streamed run (not
+   *                        with rng=shared), sweep, serve, surface
+   *                        and budget
+   *   toolong_sweep=T1,T2,...
+   *                        also report, for each 'too long' wait of
+   *                        T1, T2, ... minutes, the station count and
+   *                        toolong counts it would give, rescored
+   *                        from one simulation
+   *   cache=FILE           keep precinct results in FILE and reuse
+   *                        them in later runs (not with rng=shared)
+   *   checkpoint=FILE      save each finished precinct's output, and
+   *                        the RN state, to FILE; run again with the
+   *                        same options after a crash to pick up where
+   *                        the last saved state left off (only in a
+   *                        plain run, and not with cache, series,
+   *                        trace, timing or time_budget_ms, nor with
+   *                        arena_stats and rng=workload)
+   *   checkpoint_every=N   save the RN state and flush every N
+   *                        precincts (default 1; only with checkpoint)
+   *   shard=K/N            simulate only the K-th of N shards of the
+   *                        precincts, dealt out by expected work so
+   *                        the shards take about as long; the results
+   *                        go to the cache=FILE the shard must have
+   *                        (only in a plain run, not with rng=shared)
+   *   merge=F1,F2,...      simulate nothing, but write the report of
+   *                        a whole run from the results in the shard
+   *                        cache files F1, F2, ... (not with rng=shared)
+   *   schedule=S1,S2,...   simulate with S1 stations open in the first
+   *                        hour, S2 in the second and so on, one count
+   *                        per hour of the day; given more than once,
+   *                        each schedule is simulated against the same
+   *                        voters, resuming from the hour where it
+   *                        first differs from one already run
+   *   surface=N            instead of simulating each precinct, build
+   *                        a response surface on N expected-voter
+   *                        values and answer every precinct from it
+   *   surface_checks=K     simulate K precincts in full to measure
+   *                        the surface's error (default 5; only with
+   *                        surface)
+   *   antithetic=0|1       make iterations in pairs, the second of
+   *                        each pair drawing 1-u for every uniform u
+   *                        the first drew
+   *   budget=N             instead of finding each precinct's own
+   *                        station count, spread N stations over all
+   *                        the precincts to do the most good
+   *   control=0|1          adjust the mean wait and toolong counts by
+   *                        control variates (total service demand and
+   *                        sum of arrival times) whose means are known
+   *   arena_stats=0|1      report for each precinct the bytes its
+   *                        voter maps drew from the arena and the most
+   *                        in use in any one iteration (zero for
+   *                        results taken from a cache)
+   *   trace=FILE           write every voter of every iteration to
+   *                        FILE as a compact binary trace, see
+   *                        votertrace.h, to be read with 'tracetool'
+   *   prescreen=0|1|verify before simulating a station count second by
+   *                        second, check its voters a minute at a time
+   *                        against a lower bound on their waits, and
+   *                        report a count the bound already shows is
+   *                        too few as screened instead (not with
+   *                        toolong_sweep); 'verify' also runs the
+   *                        search without the screen and stops the
+   *                        run if the chosen counts differ
+   *   kernels=0|1          run 12 and 13 hour days and days of up to
+   *                        32 stations with the kernels specialised
+   *                        for them (default 1); the results are the
+   *                        same either way
+   *   kernel_bench=N       instead of the usual run, time N runs of
+   *                        each precinct's days with the general loops
+   *                        and with the kernels, check they agree and
+   *                        report the speedup
+   *   compress=0|gzip|zstd compress the out and log files as they are
+   *                        written, on a thread of their own, so that
+   *                        they can be read back with 'gzip -dc' or
+   *                        'zstd -dc', even while the run goes on;
+   *                        zstd only in a build with HAVE_ZSTD
+   *   compress_level=N     the level to compress at (default that of
+   *                        the codec)
+   *   arrivals=chain|order each hour's voters arrive by a chain of
+   *                        exponential gaps from the top of the hour
+   *                        (the default), or by order statistics, at
+   *                        uniform times drawn in bulk and sorted over
+   *                        a window drawn to match the chain
+   *   arrivals_check=N     instead of the usual run, make N days of
+   *                        each precinct's arrivals both ways and test
+   *                        that they agree
+   *   out_level=0|1|2      how much of the report goes to the out file:
+   *                        0 the summary lines, 1 those and the detail
+   *                        a plain run writes (the default), 2 also
+   *                        every voter of every iteration
+   *   log_level=0|1|2      the same for the log file
+   *   timing=0|1           report at the end of the run the wall time
+   *                        of the precincts by expected voters and by
+   *                        station count, the slowest precincts and
+   *                        the voters simulated a second
+   *   time_budget_ms=N     flag each precinct that takes longer than N
+   *                        milliseconds as it is written, and report
+   *                        the timing with the overruns counted
+   **/
+  bool antithetic_ = false;
+  string arrivals_ = "chain";
+  int arrivals_check_ = 0;
+  bool arena_stats_ = false;
+  bool control_variates_ = false;
+  string compress_ = "";
+  int compress_level_ = 0;
+  int log_level_ = 1;
+  int out_level_ = 1;
+  int budget_ = 0;
+  vector<vector<int> > schedules_;
+  string serve_ = "";
+  string series_filename_ = "";
+  string sweep_filename_ = "";
+  string sweep_label_ = "";
+  string trace_filename_ = "";
+  string cache_filename_ = "";
+  string checkpoint_filename_ = "";
+  int checkpoint_every_ = 1;
+  bool kernels_ = true;
+  int kernel_bench_ = 0;
+  bool prescreen_ = false;
+  bool prescreen_verify_ = false;
+  vector<string> merge_filenames_;
+  int shard_count_ = 0;
+  int shard_index_ = 0;
+  string rng_streams_ = "shared";
+  int stream_window_ = 0;
+  int surface_checks_ = 5;
+  int surface_points_ = 0;
+  int thread_count_ = 1;
+  int time_budget_ms_ = 0;
+  bool timing_ = false;
+  vector<int> toolong_sweep_;
+  vector<string> options_;
+
   /****************************************************************
    * General functions. ReadConfiguration() determines which
    * permutation of the simulation will be run. Accessor to return 
-   * the maximum accessible number of service times. 
+   * the maximum accessible number of service times. GetModes()
+   * returns the options given that choose a run other than the
+   * plain one, of which ReadOptions() allows at most one. The
+   * FastScanner version reads the same format from a mapped file
+   * and reports a malformed field by line and column. Both end
+   * with CheckLimits(), which stops the run if the day or a
+   * service time will not fit in a packed OneVoter.
+   * ReadSweepSpec() returns a copy of this configuration for each
+   * configuration a sweep spec describes, each with the fields the
+   * spec sets changed by SetSweepField() and those settings as its
+   * sweep_label_.
    **/
 
+  void CheckLimits() const;
   int GetMaxServiceSubscript() const;
+  vector<string> GetModes() const;
   void ReadConfiguration(Scanner& instream);
+  void ReadConfiguration(FastScanner& instream);
+  void ReadOptions(int argc, char *argv[], int first_option);
+  vector<Configuration> ReadSweepSpec(FastScanner& spec) const;
+  void SetSweepField(const string& name, const string& value);
+  bool UsesSharedRandom() const;
+  bool WantsVoters() const;
   string ToString();
+  string ToStringSimulationInputs() const;
 
  private:
-
+  bool HasOption(const string& name) const;
 };
 
 #endif // ONEVOTER_H
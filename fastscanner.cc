@@ -0,0 +1,322 @@
+#include "fastscanner.h"
+/****************************************************************
+ * Implementation for the 'FastScanner' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * The file is mapped read-only with mmap() and never copied. A
+ * token is whatever lies between runs of whitespace, exactly as
+ * the 'Scanner' utility defines it, so a file that the Scanner
+ * reads correctly is read the same way here. Integers are
+ * converted digit by digit straight out of the mapped bytes;
+ * doubles are handed to strtod() from a small stack buffer,
+ * because the mapped file is not NUL terminated.
+ *
+ * Any field that is not what the caller asked for is reported
+ * with the file name, line and column, and the program stops.
+ *
+**/
+
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const string kTag = "FASTSCANNER: ";
+
+// Longest token that NextDouble() will try to convert.
+static const size_t kMaxDoubleToken = 63;
+
+/****************************************************************
+ * Destructor.
+ * Releases the mapping if the caller never called Close().
+**/
+FastScanner::~FastScanner() {
+  this->Close();
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetColumn
+ * Returns the column (from 1) of the next unread character.
+**/
+int FastScanner::GetColumn() const {
+  return static_cast<int>(pos_ - line_start_) + 1;
+}
+
+/****************************************************************
+ * Function GetLine
+ * Returns the line (from 1) of the next unread character.
+**/
+int FastScanner::GetLine() const {
+  return line_;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function OpenFile
+ * Maps the named file into memory. An empty file is not mapped
+ * at all; it simply has no tokens. A file that cannot be opened
+ * stops the program, as Utils::FileOpen does.
+**/
+void FastScanner::OpenFile(string filename) {
+  this->Close();
+  filename_ = filename;
+  line_ = 1;
+  line_start_ = 0;
+  pos_ = 0;
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    cout << kTag << "ERROR opening file '" << filename << "'" << endl;
+    exit(1);
+  }
+
+  struct stat file_status;
+  if (fstat(fd, &file_status) < 0) {
+    close(fd);
+    cout << kTag << "ERROR reading size of file '" << filename << "'" << endl;
+    exit(1);
+  }
+
+  size_ = static_cast<size_t>(file_status.st_size);
+  if (size_ > 0) {
+    void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED == map) {
+      close(fd);
+      cout << kTag << "ERROR mapping file '" << filename << "'" << endl;
+      exit(1);
+    }
+    madvise(map, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(map);
+    mapped_ = true;
+  }
+  close(fd);
+}
+
+/****************************************************************
+ * Function Close
+ * Unmaps the file. Safe to call more than once.
+**/
+void FastScanner::Close() {
+  if (mapped_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+  mapped_ = false;
+  data_ = nullptr;
+  size_ = 0;
+  pos_ = 0;
+}
+
+/****************************************************************
+ * Function HasNext
+ * Returns true if there is another token anywhere in the file.
+**/
+bool FastScanner::HasNext() {
+  this->SkipWhitespace();
+  return pos_ < size_;
+}
+
+/****************************************************************
+ * Function HasNextOnLine
+ * Returns true if there is another token before the end of the
+ * current line.
+**/
+bool FastScanner::HasNextOnLine() {
+  this->SkipBlanks();
+  return (pos_ < size_) && ('\n' != data_[pos_]);
+}
+
+/****************************************************************
+ * Function Next
+ * Returns the next token as a string.
+**/
+string FastScanner::Next() {
+  if (!this->HasNext()) {
+    this->Error("expected a field, found end of file");
+  }
+  size_t end = this->TokenEnd();
+  string token(data_ + pos_, end - pos_);
+  pos_ = end;
+  return token;
+}
+
+/****************************************************************
+ * Function NextDouble
+ * Returns the next token converted to a double. The whole token
+ * must be a number.
+**/
+double FastScanner::NextDouble() {
+  if (!this->HasNext()) {
+    this->Error("expected a real number, found end of file");
+  }
+  size_t start = pos_;
+  size_t end = this->TokenEnd();
+  size_t length = end - start;
+  if (length > kMaxDoubleToken) {
+    this->ErrorAt(start, "expected a real number, found a field of "
+                         + to_string(length) + " characters");
+  }
+
+  char buffer[kMaxDoubleToken + 1];
+  memcpy(buffer, data_ + start, length);
+  buffer[length] = '\0';
+
+  char* parsed_to = nullptr;
+  double value = strtod(buffer, &parsed_to);
+  if ((0 == length) || (parsed_to != buffer + length)) {
+    this->ErrorAt(start, "expected a real number, found '"
+                         + string(buffer) + "'");
+  }
+
+  pos_ = end;
+  return value;
+}
+
+/****************************************************************
+ * Function NextInt
+ * Returns the next token converted to an int. The whole token
+ * must be an optionally signed run of decimal digits that fits
+ * in an int.
+**/
+int FastScanner::NextInt() {
+  if (!this->HasNext()) {
+    this->Error("expected an integer, found end of file");
+  }
+  size_t start = pos_;
+  size_t end = this->TokenEnd();
+
+  size_t sub = start;
+  bool negative = false;
+  if (('-' == data_[sub]) || ('+' == data_[sub])) {
+    negative = ('-' == data_[sub]);
+    ++sub;
+  }
+
+  long long value = 0;
+  bool bad = (sub == end);
+  for (; (sub < end) && !bad; ++sub) {
+    char c = data_[sub];
+    if ((c < '0') || (c > '9')) {
+      bad = true;
+      break;
+    }
+    value = 10 * value + (c - '0');
+    if (value > static_cast<long long>(INT_MAX) + 1) {
+      bad = true;
+    }
+  }
+  if (negative)
+    value = -value;
+  if (bad || (value > INT_MAX) || (value < INT_MIN)) {
+    this->ErrorAt(start, "expected an integer, found '"
+                         + string(data_ + start, end - start) + "'");
+  }
+
+  pos_ = end;
+  return static_cast<int>(value);
+}
+
+/****************************************************************
+ * Function NextLine
+ * Returns the rest of the current line, without its newline,
+ * and moves to the start of the next line.
+**/
+string FastScanner::NextLine() {
+  size_t start = pos_;
+  size_t end = start;
+  while ((end < size_) && ('\n' != data_[end])) {
+    ++end;
+  }
+  string line(data_ + start, end - start);
+  if (!line.empty() && ('\r' == line[line.size() - 1])) {
+    line.erase(line.size() - 1);
+  }
+
+  pos_ = end;
+  if (pos_ < size_) {
+    ++pos_;
+    ++line_;
+    line_start_ = pos_;
+  }
+  return line;
+}
+
+/****************************************************************
+ * Function SkipLine
+ * Discards whatever is left on the current line.
+**/
+void FastScanner::SkipLine() {
+  this->NextLine();
+}
+
+/****************************************************************
+ * Function Error
+ * Reports a problem at the current position and stops.
+**/
+void FastScanner::Error(string message) const {
+  this->ErrorAt(pos_, message);
+}
+
+/****************************************************************
+ * Private functions.
+**/
+/****************************************************************
+ * Function ErrorAt
+ * Reports a problem at the given offset of the current line,
+ * as 'file:line:column: message', and stops.
+**/
+void FastScanner::ErrorAt(size_t where, string message) const {
+  int column = static_cast<int>(where - line_start_) + 1;
+  cout << kTag << "ERROR " << filename_ << ":" << line_ << ":"
+       << column << ": " << message << endl;
+  exit(1);
+}
+
+/****************************************************************
+ * Function SkipBlanks
+ * Moves past spaces, tabs and carriage returns, stopping at a
+ * newline.
+**/
+void FastScanner::SkipBlanks() {
+  while ((pos_ < size_) && ('\n' != data_[pos_]) &&
+         isspace(static_cast<unsigned char>(data_[pos_]))) {
+    ++pos_;
+  }
+}
+
+/****************************************************************
+ * Function SkipWhitespace
+ * Moves past all whitespace, counting the newlines.
+**/
+void FastScanner::SkipWhitespace() {
+  while ((pos_ < size_) && isspace(static_cast<unsigned char>(data_[pos_]))) {
+    if ('\n' == data_[pos_]) {
+      ++line_;
+      line_start_ = pos_ + 1;
+    }
+    ++pos_;
+  }
+}
+
+/****************************************************************
+ * Function TokenEnd
+ * Returns the offset just past the token that starts at pos_.
+**/
+size_t FastScanner::TokenEnd() const {
+  size_t end = pos_;
+  while ((end < size_) && !isspace(static_cast<unsigned char>(data_[end]))) {
+    ++end;
+  }
+  return end;
+}
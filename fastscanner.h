@@ -0,0 +1,83 @@
+/****************************************************************
+ * Header for the 'FastScanner' class.
+ *
+ * A FastScanner reads a whitespace-delimited text file the same
+ * way the 'Scanner' utility does, token by token with Next(),
+ * NextInt() and NextDouble(), but it maps the whole file into
+ * memory once and converts the numeric fields in place instead
+ * of building a string for every token. It keeps track of the
+ * line and column of every token so that a bad field in a large
+ * precinct file or service-time table can be reported exactly.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef FASTSCANNER_H
+#define FASTSCANNER_H
+
+#include <cstddef>
+#include <string>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+class FastScanner {
+public:
+/****************************************************************
+ * Constructors and destructors for the class. A scanner owns its
+ * mapping and unmaps it when destroyed, so it cannot be copied.
+**/
+ FastScanner() = default;
+ FastScanner(const FastScanner&) = delete;
+ FastScanner& operator=(const FastScanner&) = delete;
+ virtual ~FastScanner();
+
+/****************************************************************
+ * Accessors for the position of the next character to be read,
+ * both counted from 1 as an editor would show them.
+**/
+ int GetColumn() const;
+ int GetLine() const;
+
+/****************************************************************
+ * General functions. These mirror the 'Scanner' functions of the
+ * same names. HasNextOnLine() and SkipLine() let a caller that
+ * reads a line-oriented file insist that a field is on the line
+ * it is reading, as 'ScanLine' would.
+**/
+ void OpenFile(string filename);
+ void Close();
+
+ bool HasNext();
+ bool HasNextOnLine();
+ string Next();
+ double NextDouble();
+ int NextInt();
+ string NextLine();
+ void SkipLine();
+
+ void Error(string message) const;
+
+private:
+ string filename_ = "";
+ const char* data_ = nullptr;
+ size_t size_ = 0;
+ size_t pos_ = 0;
+ bool mapped_ = false;
+ int line_ = 1;
+ size_t line_start_ = 0;
+
+/****************************************************************
+ * Private functions to walk over whitespace and tokens while
+ * keeping the line count current.
+**/
+ void SkipWhitespace();
+ void SkipBlanks();
+ size_t TokenEnd() const;
+ void ErrorAt(size_t where, string message) const;
+};
+
+#endif // FASTSCANNER_H
@@ -0,0 +1,186 @@
+#include "lineformat.h"
+/****************************************************************
+ * Implementation for the 'LineFormat' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * Ints are turned into digits here, from the right, which is all
+ * Utils::Format's stream does for them. Doubles go through
+ * snprintf's %*.*f, which is what the stream uses for fixed
+ * notation, so rounding, 'nan', 'inf' and '-0.00' all agree.
+ *
+**/
+
+#include <cstdio>
+#include <cstring>
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetData
+ * Returns the text built so far, which is not null-terminated.
+**/
+const char* LineFormat::GetData() const {
+  return buffer_.data();
+}
+
+/****************************************************************
+ * Function GetSize
+ * Returns the number of chars built so far.
+**/
+size_t LineFormat::GetSize() const {
+  return size_;
+}
+
+/****************************************************************
+ * Function IsEmpty
+ * Returns true if nothing has been added since Clear().
+**/
+bool LineFormat::IsEmpty() const {
+  return 0 == size_;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Add
+ * Appends 'text' as it is.
+**/
+LineFormat& LineFormat::Add(const char* text) {
+  size_t length = strlen(text);
+  memcpy(this->Extend(length), text, length);
+  return *this;
+}
+
+/****************************************************************
+ * Function Add
+ * Appends 'text' as it is.
+**/
+LineFormat& LineFormat::Add(const string& text) {
+  memcpy(this->Extend(text.size()), text.data(), text.size());
+  return *this;
+}
+
+/****************************************************************
+ * Function Add
+ * Appends 'text' right-justified to 'width'.
+**/
+LineFormat& LineFormat::Add(const string& text, int width) {
+  this->Pad(text.size(), width);
+  return this->Add(text);
+}
+
+/****************************************************************
+ * Function Add
+ * Appends 'value' right-justified to 'width'.
+**/
+LineFormat& LineFormat::Add(int value, int width) {
+  char digits[16];
+  char* start = digits + sizeof(digits);
+  unsigned int magnitude = (value < 0) ? 0u - static_cast<unsigned int>(value)
+                                       : static_cast<unsigned int>(value);
+  do {
+    *--start = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+  if (value < 0)
+    *--start = '-';
+
+  size_t length = digits + sizeof(digits) - start;
+  this->Pad(length, width);
+  memcpy(this->Extend(length), start, length);
+  return *this;
+}
+
+/****************************************************************
+ * Function Add
+ * Appends 'value' in fixed notation with 'precision' decimals,
+ * right-justified to 'width'.
+**/
+LineFormat& LineFormat::Add(double value, int width, int precision) {
+  size_t room = (width > 32) ? width + 1 : 33;
+  int length = snprintf(this->Extend(room), room, "%*.*f", width, precision,
+                        value);
+  size_ -= room;
+  if (length >= static_cast<int>(room)) {
+    room = length + 1;
+    snprintf(this->Extend(room), room, "%*.*f", width, precision, value);
+    size_ -= room;
+  }
+  size_ += length;
+  return *this;
+}
+
+/****************************************************************
+ * Function AddLeft
+ * Appends 'text' left-justified to 'width'.
+**/
+LineFormat& LineFormat::AddLeft(const string& text, int width) {
+  this->Add(text);
+  this->Pad(text.size(), width);
+  return *this;
+}
+
+/****************************************************************
+ * Function AddRepeat
+ * Appends 'count' copies of 'character'.
+**/
+LineFormat& LineFormat::AddRepeat(char character, int count) {
+  if (count > 0)
+    memset(this->Extend(count), character, count);
+  return *this;
+}
+
+/****************************************************************
+ * Function Clear
+ * Empties the text, keeping the buffer for the next.
+**/
+LineFormat& LineFormat::Clear() {
+  size_ = 0;
+  return *this;
+}
+
+/****************************************************************
+ * Function Extend
+ * Makes room for 'bytes' more chars and returns where they go,
+ * counting them as added.
+**/
+char* LineFormat::Extend(size_t bytes) {
+  if (size_ + bytes > buffer_.size())
+    buffer_.resize(2 * (size_ + bytes));
+  char* where = buffer_.data() + size_;
+  size_ += bytes;
+  return where;
+}
+
+/****************************************************************
+ * Function ForThisThread
+ * Returns the calling thread's LineFormat, emptied.
+**/
+LineFormat& LineFormat::ForThisThread() {
+  static thread_local LineFormat line;
+  return line.Clear();
+}
+
+/****************************************************************
+ * Function Pad
+ * Appends the spaces that bring a field of 'length' chars up to
+ * 'width'.
+**/
+void LineFormat::Pad(size_t length, int width) {
+  if (static_cast<int>(length) < width)
+    memset(this->Extend(width - length), ' ', width - length);
+}
+
+/****************************************************************
+ * Function ToString
+ * Returns the text built so far.
+**/
+string LineFormat::ToString() const {
+  if (0 == size_)
+    return "";
+  return string(buffer_.data(), size_);
+}
@@ -0,0 +1,73 @@
+/****************************************************************
+ * Header for the 'LineFormat' class.
+ *
+ * A LineFormat builds report text in a char buffer it keeps, by
+ * writing each fixed-width field straight into it, rather than by
+ * joining the strings Utils::Format returns. The fields come out
+ * just as Utils::Format writes them: an int right-justified to
+ * its width, a double in fixed notation to its precision and
+ * right-justified, a string right- or left-justified, and none of
+ * them cut short if they are wider than the width.
+ *
+ * Each thread has one LineFormat of its own, ForThisThread(),
+ * whose buffer grows to the longest text built on the thread and
+ * is then reused, so a report is formatted with no allocation but
+ * the one string handed to the sink. Only the function writing a
+ * report takes the thread's LineFormat; the functions it calls to
+ * format a part of a line are given it and append to it.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef LINEFORMAT_H
+#define LINEFORMAT_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class LineFormat {
+public:
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ LineFormat() = default;
+ virtual ~LineFormat() = default;
+
+/****************************************************************
+ * Accessors.
+**/
+ const char* GetData() const;
+ size_t GetSize() const;
+ bool IsEmpty() const;
+
+/****************************************************************
+ * General functions. Each Add appends one field and returns this
+ * LineFormat, so that a line can be written as one expression.
+ * AddLeft() left-justifies; AddRepeat() appends 'count' copies of
+ * a character, as for a bar of stars.
+**/
+ LineFormat& Add(const char* text);
+ LineFormat& Add(const string& text);
+ LineFormat& Add(const string& text, int width);
+ LineFormat& Add(int value, int width);
+ LineFormat& Add(double value, int width, int precision);
+ LineFormat& AddLeft(const string& text, int width);
+ LineFormat& AddRepeat(char character, int count);
+ LineFormat& Clear();
+ string ToString() const;
+
+ static LineFormat& ForThisThread();
+
+private:
+ vector<char> buffer_;
+ size_t size_ = 0;
+
+ char* Extend(size_t bytes);
+ void Pad(size_t length, int width);
+};
+
+#endif // LINEFORMAT_H
@@ -22,8 +22,8 @@ int main(int argc, char *argv[])
 
   ofstream out_stream;
 
-  Scanner config_stream;
-  Scanner pct_stream;
+  FastScanner config_stream;
+  FastScanner pct_stream;
 
   Configuration config;
   Simulation simulation;
@@ -32,58 +32,126 @@ int main(int argc, char *argv[])
 
   cout<< kTag << "Beginning execution" << endl;
 
-  Utils::CheckArgs(4, argc, argv, "configfilename pctfilename outfilename logfilename");
+  // Anything after the four file names is a 'name=value' run option.
+  int file_argc = (argc > 5) ? 5 : argc;
+  Utils::CheckArgs(4, file_argc, argv,
+                   "configfilename pctfilename outfilename logfilename "
+                   "[name=value ...]");
   config_filename = static_cast<string>(argv[1]);
   pct_filename = static_cast<string>(argv[2]);
   out_filename = static_cast<string>(argv[3]);
   log_filename = static_cast<string>(argv[4]);
 
+  ////////////////////////////////////////////////////////////////////
+  // config has RN seed, station count spread, election day length
+  //   and mean and dev voting time; the options are read before the
+  //   out and log files are opened, since they say how to write them
+  config_stream.OpenFile(config_filename);
+  config.ReadConfiguration(config_stream);
+  config_stream.Close();
+  config.ReadOptions(argc, argv, 5);
+
   Utils::FileOpen(out_stream, out_filename);
   Utils::LogFileOpen(log_filename);
+  CompressedFile out_compressed;
+  CompressedFile log_compressed;
+  if (!config.compress_.empty()) {
+    out_compressed.Attach(out_stream, config.compress_,
+                          config.compress_level_);
+    log_compressed.Attach(Utils::log_stream, config.compress_,
+                          config.compress_level_);
+  }
+  // Everything goes to both files through the one sink, each file
+  // taking what is at its level or below.
+  TeeSink sink(out_stream, Utils::log_stream, config.out_level_,
+               config.log_level_);
 
   outstring = kTag + "Beginning execution\n";
   outstring += kTag + Utils::TimeCall("beginning");
-  out_stream << outstring << endl;
-  Utils::log_stream << outstring << endl;
+  sink.Output(outstring + "\n");
 
   outstring = kTag + "outfile '" + out_filename + "'" + "\n";
   outstring += kTag + "logfile '" + log_filename + "'" + "\n";
-  out_stream << outstring << endl;
-  Utils::log_stream << outstring << endl;
+  sink.Output(outstring + "\n");
 
-  ////////////////////////////////////////////////////////////////////
-  // config has RN seed, station count spread, election day length
-  //   and mean and dev voting time
-  config_stream.OpenFile(config_filename);
-  config.ReadConfiguration(config_stream);
-  config_stream.Close();
   //Takes the config, converts it to a string, then sends it to the log file
   outstring = kTag + config.ToString() + "\n";
-  out_stream << outstring << endl;
-  Utils::log_stream << outstring << endl;
+  sink.Output(outstring + "\n");
 
   //Calls the parameterized constructor of MyRandom
   random = MyRandom(config.seed_);
 
   ////////////////////////////////////////////////////////////////////
-  // now read the precinct data
+  // now read the precinct data and do the real work, either with
+  // all the precincts in memory or streamed through a few at a time
   pct_stream.OpenFile(pct_filename);
-  simulation.ReadPrecincts(pct_stream);
-  pct_stream.Close();
-
-  ////////////////////////////////////////////////////////////////////
-  // here is the real work
-  simulation.RunSimulation(config, random, out_stream);
+  if (config.stream_window_ > 0) {
+    simulation.RunSimulationStreaming(pct_stream, config, random, sink);
+    pct_stream.Close();
+  }
+  else if (!config.serve_.empty()) {
+    simulation.ReadPrecincts(pct_stream);
+    pct_stream.Close();
+    simulation.RunServer(config, sink);
+  }
+  else if (!config.sweep_filename_.empty()) {
+    FastScanner sweep_stream;
+    sweep_stream.OpenFile(config.sweep_filename_);
+    vector<Configuration> configs = config.ReadSweepSpec(sweep_stream);
+    sweep_stream.Close();
+    simulation.ReadPrecincts(pct_stream);
+    pct_stream.Close();
+    simulation.RunSweepSpec(configs, config, sink);
+  }
+  else if (!config.schedules_.empty()) {
+    simulation.ReadPrecincts(pct_stream);
+    pct_stream.Close();
+    simulation.RunSchedules(config, random, sink);
+  }
+  else if (config.budget_ > 0) {
+    simulation.ReadPrecincts(pct_stream);
+    pct_stream.Close();
+    simulation.RunBudget(config, sink);
+  }
+  else if (config.arrivals_check_ > 0) {
+    simulation.ReadPrecincts(pct_stream);
+    pct_stream.Close();
+    simulation.RunArrivalsCheck(config, random, sink);
+  }
+  else if (config.kernel_bench_ > 0) {
+    simulation.ReadPrecincts(pct_stream);
+    pct_stream.Close();
+    simulation.RunKernelBench(config, random, sink);
+  }
+  else if (config.surface_points_ > 0) {
+    simulation.ReadPrecincts(pct_stream);
+    pct_stream.Close();
+    simulation.RunSurface(config, sink);
+  }
+  else {
+    simulation.ReadPrecincts(pct_stream);
+    pct_stream.Close();
+    simulation.RunSimulation(config, random, sink);
+  }
 
   ////////////////////////////////////////////////////////////////////
   // close up and go home
+  sink.Output(kTag + "OUTPUT " + sink.ToString() + "\n", OutputSink::kDetail);
+
   outstring = kTag + "Ending execution" + "\n";
   outstring += kTag + Utils::TimeCall("ending");
-  out_stream << outstring << endl;
-  Utils::log_stream << outstring << endl;
+  sink.Output(outstring + "\n");
 
+  out_compressed.Finish();
+  log_compressed.Finish();
   Utils::FileClose(out_stream);
   Utils::FileClose(Utils::log_stream);
+  if (!config.compress_.empty()) {
+    cout << kTag << "out file " << out_compressed.GetBytesIn()
+         << " bytes compressed to " << out_compressed.GetBytesOut() << endl;
+    cout << kTag << "log file " << log_compressed.GetBytesIn()
+         << " bytes compressed to " << log_compressed.GetBytesOut() << endl;
+  }
 
   cout<< kTag << "Ending execution" << endl;
 
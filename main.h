@@ -18,7 +18,9 @@
 using namespace std;
 
 //Other classes used from main.cc
+#include "compressedfile.h"
 #include "configuration.h"
+#include "fastscanner.h"
 #include "simulation.h"
 #include "myrandom.h"
 
@@ -1,6 +1,8 @@
 #include "myrandom.h"
 
+#include <cmath>
 #include <map>
+#include <sstream>
 
 /******************************************************************************
  *3456789 123456789 123456789 123456789 123456789 123456789 123456789 123456789
@@ -26,9 +28,65 @@ MyRandom::MyRandom(unsigned seed) {
   generator_.seed(seed_);
 }
 
+/******************************************************************************
+ * Constructor
+ * Gives an independent stream of RNs for each 'stream' number under one
+ * 'seed', so that (for example) a precinct gets the same numbers no matter
+ * which precincts were simulated before it or on which thread.
+**/
+MyRandom::MyRandom(unsigned seed, unsigned long long stream) {
+  seed_ = seed;
+  std::seed_seq sequence = { seed,
+                             static_cast<unsigned>(stream & 0xFFFFFFFFu),
+                             static_cast<unsigned>(stream >> 32) };
+  generator_.seed(sequence);
+}
+
 /******************************************************************************
  * Accessors and Mutators
 **/
+/******************************************************************************
+ * Function 'SetAntithetic'.
+ * When set, the 'ByInversion' functions use 1-u wherever they would have
+ * used the uniform u. A copy of a MyRandom taken before a run of draws,
+ * with this set, gives the antithetic partner of that run.
+**/
+void MyRandom::SetAntithetic(bool antithetic) {
+  antithetic_ = antithetic;
+}
+
+/******************************************************************************
+ * Function 'ReadState'.
+ * Puts the generator back where ToStringState() found it, so a restarted
+ * run draws the same numbers from there on as one that never stopped.
+ * Returns false, leaving the generator alone, if 'state' is not one.
+**/
+bool MyRandom::ReadState(const string& state) {
+  istringstream instream(state);
+  int antithetic = 0;
+  unsigned int seed = 0;
+  std::mt19937 generator;
+  instream >> antithetic >> seed >> generator;
+  if (!instream)
+    return false;
+  antithetic_ = (1 == antithetic);
+  seed_ = seed;
+  generator_ = generator;
+  return true;
+}
+
+/******************************************************************************
+ * Function 'ToStringState'.
+ * Returns the whole state on one line: the antithetic flag, the seed and
+ * the engine's own text form of its 624 words and position. This is a
+ * copy of a few kilobytes with no draws, so it is cheap to take after
+ * every precinct.
+**/
+string MyRandom::ToStringState() const {
+  ostringstream outstream;
+  outstream << (antithetic_ ? 1 : 0) << " " << seed_ << " " << generator_;
+  return outstream.str();
+}
 
 /******************************************************************************
  * General functions.
@@ -54,6 +112,69 @@ int MyRandom::RandomExponentialInt(double lambda) {
   return r;
 }
 
+/******************************************************************************
+ * Function 'RandomExponentialIntByInversion'.
+ * As RandomExponentialInt, but computed as -log(1-u)/lambda from one
+ * uniform u, so that it can be made antithetic.
+ *
+ * Parameters:
+ *   lambda - the lambda of the exponentially distributed RNs
+ *
+ * Returns:
+ *   the random number as an 'int' rounded from the 'double'
+**/
+int MyRandom::RandomExponentialIntByInversion(double lambda) {
+  assert(lambda > 0.0);
+  int r = round(-log(1.0 - RandomOpenUnit()) / lambda);
+  return r;
+}
+
+/******************************************************************************
+ * Function 'RandomGamma'.
+ * This generates 'double' random numbers gamma distributed with shape
+ * 'shape' and scale 1.
+ *
+ * Parameters:
+ *   shape - the shape of the gamma distributed RNs
+ *
+ * Returns:
+ *   the random number as a 'double'
+**/
+double MyRandom::RandomGamma(double shape) {
+  assert(shape > 0.0);
+  std::gamma_distribution<double> distribution(shape, 1.0);
+  double r = distribution(generator_);
+  return r;
+}
+
+/******************************************************************************
+ * Function 'RandomGammaByInversion'.
+ * Returns the sum of 'shape' exponential RNs of mean 1, each -log(1-u)
+ * from one uniform u as in RandomExponentialIntByInversion, so it can be
+ * made antithetic. The 1-u are multiplied sixteen at a time, which cannot
+ * underflow, and only each product's logarithm is taken.
+ *
+ * Parameters:
+ *   shape - how many exponentials to add
+ *
+ * Returns:
+ *   the gamma RN with that shape and scale 1
+**/
+double MyRandom::RandomGammaByInversion(int shape) {
+  assert(shape >= 0);
+  double sum = 0.0;
+  while (shape > 0) {
+    int block = (shape < 16) ? shape : 16;
+    double product = 1.0;
+    for (int sub = 0; sub < block; ++sub) {
+      product *= 1.0 - RandomOpenUnit();
+    }
+    sum -= log(product);
+    shape -= block;
+  }
+  return sum;
+}
+
 /******************************************************************************
  * Function 'RandomNormal'.
  * This generates 'double' random numbers normally distributed with
@@ -110,3 +231,69 @@ int MyRandom::RandomUniformInt(int lower, int upper) {
   int r = distribution(generator_);
   return r;
 }
+
+/******************************************************************************
+ * Function 'RandomUniformIntByInversion'.
+ * As RandomUniformInt, but computed from one uniform u, so that it can be
+ * made antithetic.
+ *
+ * Parameters:
+ *   lower - the smallest value of the RNs
+ *   upper - the largest value of the RNs
+ *
+ * Returns:
+ *   the random number as an 'int'
+**/
+int MyRandom::RandomUniformIntByInversion(int lower, int upper) {
+  assert(lower <= upper);
+  int span = upper - lower + 1;
+  int r = lower + static_cast<int>(RandomOpenUnit() * span);
+  if (r > upper)
+    r = upper;
+  return r;
+}
+
+/******************************************************************************
+ * Function 'RandomUnitsByInversion'.
+ * Puts 'count' uniform RNs strictly between 0 and 1 into 'units', each
+ * from one 32-bit draw as RandomOpenUnit() makes them, and so mirrored if
+ * antithetic draws are set. The words are drawn a block at a time and
+ * then scaled in a loop with no branches, which the compiler can
+ * vectorise.
+ *
+ * Parameters:
+ *   count - how many to draw
+ *   units - where to put them
+**/
+void MyRandom::RandomUnitsByInversion(int count, vector<double>& units) {
+  static const int kBlock = 256;
+  const double flip = antithetic_ ? 1.0 : 0.0;
+  const double sign = antithetic_ ? -1.0 : 1.0;
+  unsigned int words[kBlock];
+
+  units.resize(count);
+  for (int start = 0; start < count; start += kBlock) {
+    int block = (count - start < kBlock) ? count - start : kBlock;
+    for (int sub = 0; sub < block; ++sub) {
+      words[sub] = static_cast<unsigned int>(generator_());
+    }
+    double* out = units.data() + start;
+    for (int sub = 0; sub < block; ++sub) {
+      double u = (static_cast<double>(words[sub]) + 0.5) / 4294967296.0;
+      out[sub] = flip + sign * u;
+    }
+  }
+}
+
+/******************************************************************************
+ * Function 'RandomOpenUnit'.
+ * Returns a uniform RN strictly between 0 and 1 from one 32-bit draw, or
+ * one minus it if antithetic draws are set. Neither end is ever returned,
+ * so the logarithm above is always finite.
+**/
+double MyRandom::RandomOpenUnit() {
+  double u = (static_cast<double>(generator_()) + 0.5) / 4294967296.0;
+  if (antithetic_)
+    u = 1.0 - u;
+  return u;
+}
@@ -11,6 +11,8 @@
 
 #include <iostream>
 #include <random>
+#include <string>
+#include <vector>
 #include <cassert>
 using namespace std;
 
@@ -23,16 +25,30 @@ class MyRandom {
 public:
  MyRandom();
  MyRandom(unsigned seed);
+ MyRandom(unsigned seed, unsigned long long stream);
  virtual ~MyRandom() = default;
 
+ void SetAntithetic(bool antithetic);
+
+ bool ReadState(const string& state);
+ string ToStringState() const;
+
  int RandomExponentialInt(double mean);
+ int RandomExponentialIntByInversion(double lambda);
+ double RandomGamma(double shape);
+ double RandomGammaByInversion(int shape);
  double RandomNormal(double mean, double dev);
  double RandomUniformDouble(double lower, double upper);
  int RandomUniformInt(int lower, int upper);
+ int RandomUniformIntByInversion(int lower, int upper);
+ void RandomUnitsByInversion(int count, vector<double>& units);
 
 private:
+ bool antithetic_ = false;
  unsigned int seed_;
 
+ double RandomOpenUnit();
+
  std::mt19937 generator_;
 };
 
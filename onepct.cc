@@ -12,6 +12,11 @@
 *
 **/
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <climits>
+
 static const string kTag = "OnePct: ";
 
 /****************************************************************
@@ -43,6 +48,45 @@ int OnePct::GetPctNumber() const {
   return pct_number_;
 }
 
+/****************************************************************
+ * Function GetRegisteredVoters
+ * Returns the number of registered voters in the precinct
+**/
+int OnePct::GetRegisteredVoters() const {
+  return pct_num_voters_;
+}
+
+/****************************************************************
+ * Function GetMaxStationCount
+ * Returns the most stations RunSimulationPct will try: the
+ * minimum plus the number of hours in the day.
+**/
+int OnePct::GetMaxStationCount(const Configuration& config) const {
+  return this->GetMinStationCount(config) + config.election_day_length_hours_;
+}
+
+/****************************************************************
+ * Function GetMinStationCount
+ * Returns the fewest stations RunSimulationPct will try: enough
+ * to serve the expected voters at the mean time to vote if they
+ * came evenly over the day, and at least one.
+**/
+int OnePct::GetMinStationCount(const Configuration& config) const {
+  int min_station_count = pct_expected_voters_ * config.time_to_vote_mean_seconds_;
+  min_station_count = min_station_count / (config.election_day_length_hours_*3600);
+  if (min_station_count <= 0)
+    min_station_count = 1;
+  return min_station_count;
+}
+
+/****************************************************************
+ * Function SetExpectedVoters
+ * Sets the expected voters, as for a hypothetical turnout.
+**/
+void OnePct::SetExpectedVoters(int expected_voters) {
+  pct_expected_voters_ = expected_voters;
+}
+
 /****************************************************************
 * General functions.
 **/
@@ -72,7 +116,7 @@ void OnePct::ComputeMeanAndDev() {
   
   //Redundant Code: sum_of_wait_times_seconds is set to zero twice
   sum_of_wait_times_seconds = 0;
-  multimap<int, OneVoter>::iterator iter_multimap;
+  VoterMap::iterator iter_multimap;
   
   //Computes the average wait time
   for (iter_multimap = voters_done_voting_.begin();
@@ -96,6 +140,144 @@ void OnePct::ComputeMeanAndDev() {
   static_cast<double>(pct_expected_voters_));
 }
 
+/****************************************************************
+ * Function CreateVotersKernel
+ * CreateVoters for a day of kHours hours: the loop over the hours
+ * of the arrival plan has a bound the compiler knows. The draws,
+ * their order and the voters made are exactly those of the
+ * general loop.
+**/
+template <int kHours>
+void OnePct::CreateVotersKernel(const Configuration& config,
+                                MyRandom& random) {
+  const int max_service_subscript = config.GetMaxServiceSubscript();
+  const bool antithetic = config.antithetic_;
+  const ArrivalPlan& plan = this->GetArrivalPlan(config);
+
+  voters_backup_.clear();
+  int sequence = 0;
+  int voters_at_zero = plan.GetVotersAtZero();
+  for (int voter = 0; voter < voters_at_zero; ++voter) {
+    int durationsub = antithetic
+        ? random.RandomUniformIntByInversion(0, max_service_subscript)
+        : random.RandomUniformInt(0, max_service_subscript);
+    OneVoter one_voter(sequence, 0, config.actual_service_times_[durationsub]);
+    voters_backup_.emplace_hint(voters_backup_.end(), 0, one_voter);
+    ++sequence;
+  }
+
+  for (int hour = 0; hour < kHours; ++hour) {
+    const int voters_this_hour = plan.GetHour(hour).voters;
+    const double lambda = plan.GetHour(hour).lambda;
+    int arrival = plan.GetHour(hour).start_seconds;
+    for (int voter = 0; voter < voters_this_hour; ++voter) {
+      arrival += antithetic ? random.RandomExponentialIntByInversion(lambda)
+                            : random.RandomExponentialInt(lambda);
+      int durationsub = antithetic
+          ? random.RandomUniformIntByInversion(0, max_service_subscript)
+          : random.RandomUniformInt(0, max_service_subscript);
+      OneVoter one_voter(sequence, arrival,
+                         config.actual_service_times_[durationsub]);
+      voters_backup_.emplace_hint(voters_backup_.end(), arrival, one_voter);
+      ++sequence;
+    }
+  }
+} // void OnePct::CreateVotersKernel
+
+/****************************************************************
+ * Function: SortUnits
+ * Puts the uniforms in 'units', all strictly between 0 and 1, into
+ * 'sorted' in increasing order in expected linear time: they are
+ * dealt into as many buckets as there are uniforms, about one to a
+ * bucket, and the few out of order are then put right by an
+ * insertion sort. 'bucket_ends' is scratch space.
+**/
+static void SortUnits(const vector<double>& units, vector<double>& sorted,
+                      vector<int>& bucket_ends) {
+  int count = static_cast<int>(units.size());
+  sorted.resize(count);
+  bucket_ends.assign(count + 1, 0);
+  for (int sub = 0; sub < count; ++sub) {
+    ++bucket_ends[static_cast<int>(units[sub] * count) + 1];
+  }
+  for (int bucket = 0; bucket < count; ++bucket) {
+    bucket_ends[bucket + 1] += bucket_ends[bucket];
+  }
+  for (int sub = 0; sub < count; ++sub) {
+    sorted[bucket_ends[static_cast<int>(units[sub] * count)]++] = units[sub];
+  }
+  for (int sub = 1; sub < count; ++sub) {
+    double value = sorted[sub];
+    int into = sub;
+    while ((into > 0) && (sorted[into - 1] > value)) {
+      sorted[into] = sorted[into - 1];
+      --into;
+    }
+    sorted[into] = value;
+  }
+}
+
+/****************************************************************
+ * Function CreateVotersOrdered
+ * CreateVoters by order statistics. The general loop's N voters
+ * of an hour arrive at the first N points of a Poisson process
+ * with rate N per hour, and those are distributed as N sorted
+ * uniforms spread over a window the length of the first N+1
+ * points, a gamma RN with shape N+1. So each hour draws that
+ * window, then its N arrival times as one bulk draw of uniforms,
+ * bucket sorted, with no chain of gaps; as in the general loop, voters
+ * can arrive after the end of their hour. The voters are
+ * numbered in order of arrival, and each then draws a duration
+ * as in the general loop. With antithetic pairing the window is
+ * a sum of exponentials by inversion, so that the pair mirrors as
+ * it does there.
+**/
+void OnePct::CreateVotersOrdered(const Configuration& config,
+                                 MyRandom& random) {
+  const int max_service_subscript = config.GetMaxServiceSubscript();
+  const bool antithetic = config.antithetic_;
+  const ArrivalPlan& plan = this->GetArrivalPlan(config);
+
+  voters_backup_.clear();
+  int sequence = 0;
+  int voters_at_zero = plan.GetVotersAtZero();
+  for (int voter = 0; voter < voters_at_zero; ++voter) {
+    int durationsub = antithetic
+        ? random.RandomUniformIntByInversion(0, max_service_subscript)
+        : random.RandomUniformInt(0, max_service_subscript);
+    OneVoter one_voter(sequence, 0, config.actual_service_times_[durationsub]);
+    voters_backup_.emplace_hint(voters_backup_.end(), 0, one_voter);
+    ++sequence;
+  }
+
+  vector<double> units;
+  vector<double> sorted;
+  vector<int> bucket_ends;
+  for (int hour = 0; hour < plan.GetHoursCount(); ++hour) {
+    int voters_this_hour = plan.GetHour(hour).voters;
+    if (voters_this_hour <= 0)
+      continue;
+
+    int shape = voters_this_hour + 1;
+    double window = (antithetic ? random.RandomGammaByInversion(shape)
+                                : random.RandomGamma(shape))
+                  * 3600.0 / voters_this_hour;
+    random.RandomUnitsByInversion(voters_this_hour, units);
+    SortUnits(units, sorted, bucket_ends);
+    for (int voter = 0; voter < voters_this_hour; ++voter) {
+      int arrival = plan.GetHour(hour).start_seconds
+                  + static_cast<int>(round(sorted[voter] * window));
+      int durationsub = antithetic
+          ? random.RandomUniformIntByInversion(0, max_service_subscript)
+          : random.RandomUniformInt(0, max_service_subscript);
+      OneVoter one_voter(sequence, arrival,
+                         config.actual_service_times_[durationsub]);
+      voters_backup_.emplace_hint(voters_backup_.end(), arrival, one_voter);
+      ++sequence;
+    }
+  }
+} // void OnePct::CreateVotersOrdered
+
 /****************************************************************
  * Function CreateVoters
  * Written by Alexander Reeser {
@@ -113,25 +295,47 @@ void OnePct::ComputeMeanAndDev() {
  * and duration (time it take the voter to vote) which is then added to the 
  * voters_backup_ map.
  * } endReeser 
+ * With antithetic pairing the draws are made by inversion from
+ * one uniform each, so that a mirrored MyRandom gives the pair.
+ * With kernels on, 12 and 13 hour days go to CreateVotersKernel.
+ * With arrivals=order every day goes to CreateVotersOrdered.
 **/
-void OnePct::CreateVoters(const Configuration& config, MyRandom& random,
-                          ofstream& out_stream) {
+void OnePct::CreateVoters(const Configuration& config, MyRandom& random) {
+  if ("order" == config.arrivals_) {
+    this->CreateVotersOrdered(config, random);
+    return;
+  }
+  if (config.kernels_) {
+    if (12 == config.election_day_length_hours_) {
+      this->CreateVotersKernel<12>(config, random);
+      return;
+    }
+    if (13 == config.election_day_length_hours_) {
+      this->CreateVotersKernel<13>(config, random);
+      return;
+    }
+  }
+
   int duration = 0;
   int arrival = 0;
   int sequence = 0;
-  double percent = 0.0;
   string outstring = "XX";
+  const ArrivalPlan& plan = this->GetArrivalPlan(config);
 
   voters_backup_.clear();
   sequence = 0;
 
-  percent = config.arrival_zero_;
-  int voters_at_zero = round((percent / 100.0) * pct_expected_voters_);
+  int voters_at_zero = plan.GetVotersAtZero();
   arrival = 0;
   
   //voters_at_zero is always zero.
   for (int voter = 0; voter < voters_at_zero; ++voter) {
-    int durationsub = random.RandomUniformInt(0, config.GetMaxServiceSubscript());
+    int durationsub = 0;
+    if (config.antithetic_)
+      durationsub = random.RandomUniformIntByInversion(0,
+                                        config.GetMaxServiceSubscript());
+    else
+      durationsub = random.RandomUniformInt(0, config.GetMaxServiceSubscript());
     duration = config.actual_service_times_.at(durationsub);
     OneVoter one_voter(sequence, arrival, duration);
     voters_backup_.insert(std::pair<int, OneVoter>(arrival, one_voter));
@@ -139,29 +343,34 @@ void OnePct::CreateVoters(const Configuration& config, MyRandom& random,
   }
 
   //Runs once for every hour the polls are open.
-  for (int hour = 0; hour < config.election_day_length_hours_; ++hour) {
-    //Gets the percentage of voters voting at that hour.
-    percent = config.arrival_fractions_.at(hour);
-    //Aproximates the number of voters in an hour
-    int voters_this_hour = round((percent / 100.0) * pct_expected_voters_);
-    //Adds one to the number of voters in an hour half the time in order
-    //to offset the error caused by integers rounding down.
-    if (0 == hour%2) 
-      ++voters_this_hour;
+  for (int hour = 0; hour < plan.GetHoursCount(); ++hour) {
+    //Gets the number of voters in the hour from the arrival plan,
+    //which has the percentage of voters voting at that hour, rounded,
+    //plus one half the time to offset the integers rounding down.
+    int voters_this_hour = plan.GetHour(hour).voters;
     
     //Integer used to find the time of a voter's arrival in seconds
-    int arrival = hour*3600;
+    int arrival = plan.GetHour(hour).start_seconds;
     for(int voter = 0; voter < voters_this_hour; ++voter) {
-      //Finds the average number of voters arriving every second.
+      //The average number of voters arriving every second.
       //This number is used to calculate a RandomExponentialInt
       //which is used to simulate the time the next voter will arrive.
-      double lambda = static_cast<double>(voters_this_hour / 3600.0);
-      int interarrival = random.RandomExponentialInt(lambda);
+      double lambda = plan.GetHour(hour).lambda;
+      int interarrival = 0;
+      if (config.antithetic_)
+        interarrival = random.RandomExponentialIntByInversion(lambda);
+      else
+        interarrival = random.RandomExponentialInt(lambda);
       arrival += interarrival;
       
       //Gets a random voting duration from the actual_service_times_
       //Integer vector by getting a random number with GetMaxServiceSubscript
-      int durationsub = random.RandomUniformInt(0, config.GetMaxServiceSubscript());
+      int durationsub = 0;
+      if (config.antithetic_)
+        durationsub = random.RandomUniformIntByInversion(0,
+                                          config.GetMaxServiceSubscript());
+      else
+        durationsub = random.RandomUniformInt(0, config.GetMaxServiceSubscript());
       duration = config.actual_service_times_.at(durationsub);
 
       //Creates a voter using the sequence (voter number), arrival (arrival time),
@@ -174,6 +383,54 @@ void OnePct::CreateVoters(const Configuration& config, MyRandom& random,
   }
 }
 
+/****************************************************************
+ * Function GetArrivalPlan
+ * Returns the arrival plan for 'config' and the expected voters,
+ * the one kept from the last call if it still fits, so that the
+ * shared plans are only looked up when a precinct's expected
+ * voters or the configuration's arrivals change.
+**/
+const ArrivalPlan& OnePct::GetArrivalPlan(const Configuration& config) {
+  if ((nullptr == arrival_plan_) ||
+      !arrival_plan_->Fits(config, pct_expected_voters_)) {
+    arrival_plan_ = ArrivalPlan::For(config, pct_expected_voters_);
+  }
+  return *arrival_plan_;
+}
+
+/****************************************************************
+ * Function CreateIterationVoters
+ * Creates the voters of one iteration in voters_backup_. With
+ * antithetic pairing the even iteration of a pair saves the
+ * generator in 'pair_start', and the odd one replays that stream
+ * mirrored.
+**/
+void OnePct::CreateIterationVoters(const Configuration& config,
+                                   MyRandom& random, int iteration,
+                                   MyRandom& pair_start) {
+  if (config.antithetic_ && (1 == iteration%2)) {
+    MyRandom mirror = pair_start;
+    mirror.SetAntithetic(true);
+    this->CreateVoters(config, mirror);
+  }
+  else {
+    if (config.antithetic_)
+      pair_start = random;
+    this->CreateVoters(config, random);
+  }
+}
+
+/****************************************************************
+ * Function ClearVoterMaps
+ * Empties all four voter maps.
+**/
+void OnePct::ClearVoterMaps() {
+  voters_backup_.clear();
+  voters_done_voting_.clear();
+  voters_pending_.clear();
+  voters_voting_.clear();
+}
+
 /******************************************************************************
  * Function DoStatistics
  * Written by Ahmed Abdellatif {
@@ -189,15 +446,19 @@ void OnePct::CreateVoters(const Configuration& config, MyRandom& random,
  *
  *
  * } endAhmed
+ * The counts, mean and deviation are returned in an IterationStats,
+ * with the total service demand and sum of arrival times as
+ * control variates, and, for a toolong sweep, the histogram of
+ * waits; the report line itself is made by FormatStatistics().
 **/
-int OnePct::DoStatistics(int iteration, const Configuration& config,
-                         int station_count, map<int, int>& map_for_histo,
-                         ofstream& out_stream) {
-  string outstring = "\n";
+PctResult::IterationStats OnePct::DoStatistics(int iteration,
+                                               const Configuration& config,
+                                               map<int, int>& map_for_histo) {
+  PctResult::IterationStats stats;
   map<int, int> wait_time_minutes_map;
 
 /////////////////////////////////////////////////////////////////////////////
-  multimap<int, OneVoter>::iterator iter_multimap;
+  VoterMap::iterator iter_multimap;
   for (iter_multimap = this->voters_done_voting_.begin();
        iter_multimap != this->voters_done_voting_.end(); ++iter_multimap) {
     OneVoter voter = iter_multimap->second;
@@ -205,6 +466,10 @@ int OnePct::DoStatistics(int iteration, const Configuration& config,
 
     ++(wait_time_minutes_map[wait_time_minutes]);
     ++(map_for_histo[wait_time_minutes]);
+
+    stats.service_demand_seconds += voter.GetTimeDoneVoting()
+                                  - voter.GetTimeArrival() - voter.GetTimeInQ();
+    stats.arrival_sum_seconds += voter.GetTimeArrival();
   }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -225,30 +490,56 @@ int OnePct::DoStatistics(int iteration, const Configuration& config,
 
 /////////////////////////////////////////////////////////////////////////////
   ComputeMeanAndDev();
-  outstring = "";
-  outstring += kTag + Utils::Format(iteration, 3) + " "
-            + Utils::Format(pct_number_, 4) + " "
-            + Utils::Format(pct_name_, 25, "left")
-            + Utils::Format(pct_expected_voters_, 6)
-            + Utils::Format(station_count, 4)
-            + " stations, mean/dev wait (mins) "
-            + Utils::Format(wait_mean_seconds_/60.0, 8, 2) + " "
-            + Utils::Format(wait_dev_seconds_/60.0, 8, 2) + " toolong "
-            + Utils::Format(toolongcount, 6) + " "
-            + Utils::Format(100.0*toolongcount/(double)pct_expected_voters_, 6, 2)
-            + Utils::Format(toolongcountplus10, 6) + " "
-            + Utils::Format(100.0*toolongcountplus10/(double)pct_expected_voters_, 6, 2)
-            + Utils::Format(toolongcountplus20, 6) + " "
-            + Utils::Format(100.0*toolongcountplus20/(double)pct_expected_voters_, 6, 2)
-            + "\n";
-
-  Utils::Output(outstring, out_stream, Utils::log_stream);
+  stats.iteration = iteration;
+  stats.wait_mean_seconds = wait_mean_seconds_;
+  stats.wait_dev_seconds = wait_dev_seconds_;
+  stats.toolong_count = toolongcount;
+  stats.toolong_count_plus10 = toolongcountplus10;
+  stats.toolong_count_plus20 = toolongcountplus20;
 
+  if (!config.toolong_sweep_.empty())
+    stats.wait_minutes.swap(wait_time_minutes_map);
   wait_time_minutes_map.clear();
 
-  return toolongcount;
+  return stats;
 }
 
+/****************************************************************
+ * Function ExpectedControls
+ * Sets the expected total service demand and sum of arrival
+ * times of one iteration's voters, worked out from the same
+ * voter counts CreateVoters makes. A service time is a uniform
+ * pick from actual_service_times_. An interarrival is a rounded
+ * exponential, whose mean is exp(-lambda/2)/(1-exp(-lambda)),
+ * and the j-th voter of an hour arrives after j of them.
+**/
+void OnePct::ExpectedControls(const Configuration& config,
+                              double& service_demand_seconds,
+                              double& arrival_sum_seconds) const {
+  double service_mean = 0.0;
+  for (auto iter = config.actual_service_times_.begin();
+            iter != config.actual_service_times_.end(); ++iter) {
+    service_mean += *iter;
+  }
+  service_mean /= static_cast<double>(config.actual_service_times_.size());
+
+  shared_ptr<const ArrivalPlan> plan =
+      ArrivalPlan::For(config, pct_expected_voters_);
+  arrival_sum_seconds = 0.0;
+  for (int hour = 0; hour < plan->GetHoursCount(); ++hour) {
+    const ArrivalPlan::Hour& one_hour = plan->GetHour(hour);
+    if (one_hour.voters <= 0)
+      continue;
+
+    double lambda = one_hour.lambda;
+    double interarrival_mean = exp(-lambda / 2.0) / (1.0 - exp(-lambda));
+    double count = static_cast<double>(one_hour.voters);
+    arrival_sum_seconds += count * one_hour.start_seconds
+                         + interarrival_mean * count * (count + 1.0) / 2.0;
+  }
+  service_demand_seconds = plan->GetVotersCount() * service_mean;
+} // void OnePct::ExpectedControls
+
 /****************************************************************
  * Function ReadData
  * Written by Alexander Reeser {
@@ -276,8 +567,428 @@ void OnePct::ReadData(Scanner& infile) {
   }
 } // void OnePct::ReadData(Scanner& infile)
 
+/****************************************************************
+ * Function ReadData
+ * The same eleven fields as above, read from a FastScanner so
+ * that a bad field is reported with its line and column.
+**/
+void OnePct::ReadData(FastScanner& infile) {
+  if (infile.HasNext()) {
+    pct_number_ = infile.NextInt();
+    pct_name_ = infile.Next();
+    pct_turnout_ = infile.NextDouble();
+    pct_num_voters_ = infile.NextInt();
+    pct_expected_voters_ = infile.NextInt();
+    pct_expected_per_hour_ = infile.NextInt();
+    pct_stations_ = infile.NextInt();
+    pct_minority_ = infile.NextDouble();
+
+    int stat1 = infile.NextInt();
+    int stat2 = infile.NextInt();
+    int stat3 = infile.NextInt();
+    stations_to_histo_.insert(stat1);
+    stations_to_histo_.insert(stat2);
+    stations_to_histo_.insert(stat3);
+  }
+} // void OnePct::ReadData(FastScanner& infile)
+
 /****************************************************************
  * Function RunSimulationPct
+ * Works out the precinct's result and writes its report.
+**/
+void OnePct::RunSimulationPct(const Configuration& config,
+                       MyRandom& random, OutputSink& sink) {
+  PctResult result = this->ComputeResult(config, random);
+  this->ReportResult(result, config, sink);
+} //void RunSimulationPct
+
+/****************************************************************
+ * Function: SameVoters
+ * Returns true if two voter maps hold the same voters, with the
+ * same times and stations, in the same order.
+**/
+static bool SameVoters(const VoterMap& first, const VoterMap& second) {
+  if (first.size() != second.size())
+    return false;
+  for (auto one = first.begin(), two = second.begin(); one != first.end();
+            ++one, ++two) {
+    if ((one->first != two->first) ||
+        (one->second.ToString() != two->second.ToString()))
+      return false;
+  }
+  return true;
+}
+
+/****************************************************************
+ * Function: KsStatistic
+ * Returns the two-sample Kolmogorov-Smirnov statistic, the largest
+ * gap between the empirical distributions of 'first' and 'second',
+ * which it sorts.
+**/
+static double KsStatistic(vector<double>& first, vector<double>& second) {
+  sort(first.begin(), first.end());
+  sort(second.begin(), second.end());
+  double n1 = static_cast<double>(first.size());
+  double n2 = static_cast<double>(second.size());
+  double d = 0.0;
+  size_t one = 0;
+  size_t two = 0;
+  while ((one < first.size()) && (two < second.size())) {
+    double value = min(first[one], second[two]);
+    while ((one < first.size()) && (first[one] == value))
+      ++one;
+    while ((two < second.size()) && (second[two] == value))
+      ++two;
+    d = max(d, fabs(one / n1 - two / n2));
+  }
+  return d;
+}
+
+/****************************************************************
+ * Function: KsProbability
+ * Returns the probability of a statistic of at least 'd' from
+ * samples of sizes 'n1' and 'n2' of the same distribution, by the
+ * asymptotic Kolmogorov series with Stephens' correction. With
+ * ties, as arrival seconds have, the test is conservative.
+**/
+static double KsProbability(double d, size_t n1, size_t n2) {
+  if ((0 == n1) || (0 == n2))
+    return 1.0;
+  double n = sqrt(static_cast<double>(n1) * n2 / (n1 + n2));
+  double lambda = (n + 0.12 + 0.11 / n) * d;
+  if (lambda < 0.2)
+    return 1.0;
+  double sum = 0.0;
+  double sign = 1.0;
+  for (int j = 1; j <= 100; ++j) {
+    double term = sign * exp(-2.0 * j * j * lambda * lambda);
+    sum += term;
+    if (fabs(term) < 1.0e-12)
+      break;
+    sign = -sign;
+  }
+  return min(1.0, max(0.0, 2.0 * sum));
+}
+
+/****************************************************************
+ * Function RunArrivalsCheck
+ * Creates arrivals_check_ days of voters with the chain of gaps
+ * and as many with order statistics, and compares the two with
+ * Kolmogorov-Smirnov tests: on the gaps between each hour's
+ * arrivals, from the top of the hour and scaled by the hour's
+ * rate, and on the arrival times of day. Writes a line with both
+ * statistics, their probabilities and, for each way, the percent
+ * of arrivals that run past the end of their hour. Adds one to
+ * 'differ' if either test rejects at the 1% level.
+**/
+void OnePct::RunArrivalsCheck(const Configuration& config, MyRandom& random,
+                              OutputSink& sink, int& differ) {
+  Configuration configs[2] = { config, config };
+  configs[0].arrivals_ = "chain";
+  configs[1].arrivals_ = "order";
+
+  const ArrivalPlan& plan = this->GetArrivalPlan(config);
+
+  vector<double> gaps[2];
+  vector<double> times[2];
+  long long past_hour[2] = { 0, 0 };
+  vector<int> arrivals;
+  for (int day = 0; day < config.arrivals_check_; ++day) {
+    for (int which = 0; which < 2; ++which) {
+      this->CreateVoters(configs[which], random);
+      arrivals.assign(voters_backup_.size(), 0);
+      for (auto iter = voters_backup_.begin();
+                iter != voters_backup_.end(); ++iter) {
+        arrivals[iter->second.GetSequence()] = iter->second.GetTimeArrival();
+      }
+
+      int sub = plan.GetVotersAtZero();
+      for (int hour = 0; hour < plan.GetHoursCount(); ++hour) {
+        const ArrivalPlan::Hour& one_hour = plan.GetHour(hour);
+        int previous = one_hour.start_seconds;
+        for (int voter = 0; voter < one_hour.voters; ++voter) {
+          gaps[which].push_back((arrivals[sub] - previous) * one_hour.lambda);
+          times[which].push_back(arrivals[sub]);
+          if (arrivals[sub] >= (hour + 1)*3600)
+            ++past_hour[which];
+          previous = arrivals[sub];
+          ++sub;
+        }
+      }
+    }
+  }
+  this->ClearVoterMaps();
+
+  size_t count = gaps[0].size();
+  double gaps_d = KsStatistic(gaps[0], gaps[1]);
+  double gaps_p = KsProbability(gaps_d, count, count);
+  double times_d = KsStatistic(times[0], times[1]);
+  double times_p = KsProbability(times_d, count, count);
+  bool different = (gaps_p < 0.01) || (times_p < 0.01);
+  if (different)
+    ++differ;
+
+  string outstring = kTag + "ARRIVALS " + Utils::Format(pct_number_, 4)
+                   + Utils::Format(pct_expected_voters_, 6)
+                   + " voters " + Utils::Format((double)count, 9, 0)
+                   + " gaps D " + Utils::Format(gaps_d, 7, 4)
+                   + " p " + Utils::Format(gaps_p, 6, 4)
+                   + " times D " + Utils::Format(times_d, 7, 4)
+                   + " p " + Utils::Format(times_p, 6, 4)
+                   + " past hour "
+                   + Utils::Format(count > 0 ? 100.0 * past_hour[0] / count
+                                             : 0.0, 6, 2) + "%"
+                   + Utils::Format(count > 0 ? 100.0 * past_hour[1] / count
+                                             : 0.0, 6, 2) + "%"
+                   + (different ? " DIFFERENT" : "") + "\n";
+  sink.Output(outstring);
+} // void OnePct::RunArrivalsCheck
+
+/****************************************************************
+ * Function RunKernelBench
+ * For each station count ComputeResult could try, creates one
+ * iteration's voters kernel_bench_ times and runs the day on them
+ * kernel_bench_ times, first with the general loops and then with
+ * the kernels, and writes a line with the milliseconds each took
+ * and whether the voters created and the voters done agree. The
+ * milliseconds are added to 'generic_ms' and 'kernel_ms'. Both
+ * days skip the seconds in which nothing happens, so the times
+ * differ only by what the kernels specialise.
+**/
+void OnePct::RunKernelBench(const Configuration& config, MyRandom& random,
+                            OutputSink& sink, double& generic_ms,
+                            double& kernel_ms) {
+  Configuration generic_config = config;
+  generic_config.kernels_ = false;
+  Configuration kernel_config = config;
+  kernel_config.kernels_ = true;
+  int repeats = config.kernel_bench_;
+
+  for (int stations_count = this->GetMinStationCount(config);
+           stations_count <= this->GetMaxStationCount(config);
+           ++stations_count) {
+    double create_ms[2] = { 0.0, 0.0 };
+    double day_ms[2] = { 0.0, 0.0 };
+    VoterMap created[2];
+    VoterMap done[2];
+    MyRandom draw;
+
+    for (int kernel = 0; kernel < 2; ++kernel) {
+      const Configuration& the_config = kernel ? kernel_config
+                                               : generic_config;
+      auto started = chrono::steady_clock::now();
+      for (int repeat = 0; repeat < repeats; ++repeat) {
+        draw = random;
+        this->CreateVoters(the_config, draw);
+      }
+      auto finished = chrono::steady_clock::now();
+      create_ms[kernel] = chrono::duration<double, milli>(finished
+                                                          - started).count();
+      created[kernel] = voters_backup_;
+
+      started = chrono::steady_clock::now();
+      for (int repeat = 0; repeat < repeats; ++repeat) {
+        voters_pending_ = voters_backup_;
+        this->RunDay(the_config, stations_count, nullptr);
+      }
+      finished = chrono::steady_clock::now();
+      day_ms[kernel] = chrono::duration<double, milli>(finished
+                                                       - started).count();
+      done[kernel] = voters_done_voting_;
+    }
+    random = draw;
+    generic_ms += create_ms[0] + day_ms[0];
+    kernel_ms += create_ms[1] + day_ms[1];
+
+    bool same = SameVoters(created[0], created[1])
+             && SameVoters(done[0], done[1]);
+    string outstring = kTag + "KERNEL " + Utils::Format(pct_number_, 4)
+                     + Utils::Format(pct_expected_voters_, 6)
+                     + Utils::Format(stations_count, 4) + " stations"
+                     + " voters ms " + Utils::Format(create_ms[0], 9, 2)
+                     + Utils::Format(create_ms[1], 9, 2)
+                     + Utils::Format(create_ms[0] / create_ms[1], 7, 2) + "x"
+                     + " day ms " + Utils::Format(day_ms[0], 9, 2)
+                     + Utils::Format(day_ms[1], 9, 2)
+                     + Utils::Format(day_ms[0] / day_ms[1], 7, 2) + "x"
+                     + (stations_count > 32 ? " no kernel" : "")
+                     + (same ? "" : " DIFFERENT") + "\n";
+    sink.Output(outstring);
+  }
+  this->ClearVoterMaps();
+} // void OnePct::RunKernelBench
+
+/****************************************************************
+ * Function RunSchedules
+ * Simulates each of the configuration's station schedules for
+ * number_of_iterations_ iterations and writes, per schedule, the
+ * mean over the iterations of DoStatistics' figures.
+ *
+ * Every schedule in an iteration serves the same voters. The
+ * schedules are run in sorted order, so that each shares as long
+ * a run of opening hours as it can with the one before it, and
+ * each starts from the snapshot of the queue at the first hour
+ * where it differs rather than at second zero. The seconds
+ * actually simulated are reported against what running every
+ * schedule from the start would have cost.
+**/
+void OnePct::RunSchedules(const Configuration& config, MyRandom& random,
+                          OutputSink& sink) {
+  const vector<vector<int> >& schedules = config.schedules_;
+  int schedule_count = static_cast<int>(schedules.size());
+  string outstring = "XX";
+
+  vector<int> order;
+  for (int sub = 0; sub < schedule_count; ++sub) {
+    order.push_back(sub);
+  }
+  sort(order.begin(), order.end(), [&schedules](int a, int b) {
+    return schedules.at(a) < schedules.at(b);
+  });
+
+  vector<vector<PctResult::IterationStats> > all_stats(schedule_count);
+  vector<int> resumed_from(schedule_count, 0);
+  long long seconds_simulated = 0;
+  long long seconds_from_start = 0;
+  for (int iteration = 0;
+       iteration < config.number_of_iterations_; ++iteration) {
+    this->CreateVoters(config, random);
+
+    vector<QueueState> snapshots;
+    for (int sub = 0; sub < schedule_count; ++sub) {
+      const vector<int>& schedule = schedules.at(order.at(sub));
+      int resume_hour = 0;
+      if (sub > 0) {
+        const vector<int>& previous = schedules.at(order.at(sub - 1));
+        while ((resume_hour < static_cast<int>(schedule.size())) &&
+               (previous.at(resume_hour) == schedule.at(resume_hour))) {
+          ++resume_hour;
+        }
+        resume_hour = min(resume_hour, static_cast<int>(snapshots.size()) - 1);
+      }
+
+      int seconds = this->RunSimulationSchedule(schedule, resume_hour,
+                                                snapshots);
+      seconds_simulated += seconds;
+      seconds_from_start += resume_hour * 3600 + seconds;
+      resumed_from.at(order.at(sub)) = resume_hour;
+
+      map<int, int> map_for_histo;
+      all_stats.at(order.at(sub)).push_back(this->DoStatistics(iteration,
+                                                   config, map_for_histo));
+    }
+  }
+  voters_pending_.clear();
+  voters_voting_.clear();
+  voters_done_voting_.clear();
+
+  for (int sub = 0; sub < schedule_count; ++sub) {
+    const vector<PctResult::IterationStats>& stats = all_stats.at(sub);
+    double wait_mean = 0.0;
+    double wait_dev = 0.0;
+    double toolong = 0.0;
+    for (auto iter = stats.begin(); iter != stats.end(); ++iter) {
+      wait_mean += iter->wait_mean_seconds;
+      wait_dev += iter->wait_dev_seconds;
+      toolong += iter->toolong_count;
+    }
+    double iterations = static_cast<double>(stats.size());
+    wait_mean /= iterations;
+    wait_dev /= iterations;
+    toolong /= iterations;
+
+    string stations = "";
+    for (auto iter = schedules.at(sub).begin();
+              iter != schedules.at(sub).end(); ++iter) {
+      stations += Utils::Format(*iter, 3);
+    }
+    outstring = kTag + "SCHEDULE " + Utils::Format(pct_number_, 4)
+              + Utils::Format(pct_expected_voters_, 6) + " stations"
+              + stations + " mean/dev wait (mins) "
+              + Utils::Format(wait_mean/60.0, 8, 2) + " "
+              + Utils::Format(wait_dev/60.0, 8, 2) + " toolong "
+              + Utils::Format(toolong, 8, 1) + " "
+              + Utils::Format(100.0*toolong/(double)pct_expected_voters_, 6, 2)
+              + " from hour " + Utils::Format(resumed_from.at(sub), 2) + "\n";
+    sink.Output(outstring);
+  }
+
+  double saved = (seconds_from_start > 0)
+               ? 100.0 * (seconds_from_start - seconds_simulated)
+                       / seconds_from_start : 0.0;
+  outstring = kTag + "SCHEDULE seconds simulated "
+            + Utils::Format(static_cast<double>(seconds_simulated), 12, 0)
+            + " of " + Utils::Format(static_cast<double>(seconds_from_start), 12, 0)
+            + " (" + Utils::Format(saved, 6, 2) + "% saved by resuming)\n";
+  sink.Output(outstring);
+} // void OnePct::RunSchedules
+
+/****************************************************************
+ * Function RunToolongSweep
+ * Simulates once with the shortest 'too long' wait of the sweep
+ * and the configuration's own, which goes through the most
+ * station counts, keeping every iteration's histogram of waits.
+ * The usual report for the configuration's 'too long' and one
+ * SWEEP line per swept value are then rescored from that one
+ * simulation. With rng=shared the draws run further than a
+ * plain run's would, so later precincts see different numbers.
+ * Returns the result of the one simulation.
+**/
+PctResult OnePct::RunToolongSweep(const Configuration& config,
+                                  MyRandom& random, OutputSink& sink) {
+  Configuration sweep_config = config;
+  int shortest = config.wait_time_minutes_that_is_too_long_;
+  for (auto iter = config.toolong_sweep_.begin();
+            iter != config.toolong_sweep_.end(); ++iter) {
+    shortest = min(shortest, *iter);
+  }
+  sweep_config.wait_time_minutes_that_is_too_long_ = shortest;
+
+  PctResult result = this->ComputeResult(sweep_config, random);
+  PctResult own = result.Rescore(config.wait_time_minutes_that_is_too_long_);
+  this->ReportResult(own, config, sink);
+
+  int counts_rerun = static_cast<int>(own.stations_.size());
+  for (auto iter = config.toolong_sweep_.begin();
+            iter != config.toolong_sweep_.end(); ++iter) {
+    PctResult rescored = result.Rescore(*iter);
+    counts_rerun += static_cast<int>(rescored.stations_.size());
+
+    const PctResult::StationStats& last = rescored.stations_.back();
+    double wait_sum = 0.0;
+    double toolong_sum = 0.0;
+    bool good_enough = true;
+    for (auto stats = last.iterations.begin();
+              stats != last.iterations.end(); ++stats) {
+      wait_sum += stats->wait_mean_seconds;
+      toolong_sum += stats->toolong_count;
+      if (stats->toolong_count > 0)
+        good_enough = false;
+    }
+    double iterations = static_cast<double>(last.iterations.size());
+
+    string outstring = kTag + "SWEEP " + Utils::Format(pct_number_, 4)
+                     + Utils::Format(pct_expected_voters_, 6)
+                     + " toolong " + Utils::Format(*iter, 4) + " mins "
+                     + Utils::Format(last.station_count, 4)
+                     + " stations, mean wait (mins) "
+                     + Utils::Format(wait_sum/iterations/60.0, 8, 2)
+                     + " toolong "
+                     + Utils::Format(toolong_sum/iterations, 8, 1) + " "
+                     + Utils::Format(100.0*toolong_sum/iterations/
+                                     (double)pct_expected_voters_, 6, 2)
+                     + (good_enough ? "" : " NOT REACHED") + "\n";
+    sink.Output(outstring);
+  }
+  sink.Output(kTag + "SWEEP station counts simulated "
+              + Utils::Format(static_cast<int>(result.stations_.size()), 4)
+              + ", one run per 'too long' would have simulated "
+              + Utils::Format(counts_rerun, 4) + "\n");
+  return result;
+} // PctResult OnePct::RunToolongSweep
+
+/****************************************************************
+ * Function ComputeResult
  * Written by Alexander Reeser {
  * This function starts by computing the range of stations for
  * which the simulation will run. The min_station_count is 
@@ -298,17 +1009,19 @@ void OnePct::ReadData(Scanner& infile) {
  * is used to determine if that time was too long. The data
  * for the simulation is then sent to the Output.
  * } endReeser 
+ * The statistics are collected in a PctResult rather than
+ * written as they are found; ReportResult() writes them. With
+ * the prescreen on, a count ScreenStationCount() shows to be too
+ * few is kept as screened rather than simulated; the counts
+ * tried and the one chosen are the same either way.
 **/
-void OnePct::RunSimulationPct(const Configuration& config,
-                       MyRandom& random, ofstream& out_stream) {
-  string outstring = "XX";
-
-  int min_station_count = pct_expected_voters_ * config.time_to_vote_mean_seconds_;
-  min_station_count = min_station_count / (config.election_day_length_hours_*3600);
-  if (min_station_count <= 0)
-    min_station_count = 1;
+PctResult OnePct::ComputeResult(const Configuration& config,
+                                MyRandom& random) {
+  PctResult result;
+  MyRandom exact_random = random;
 
-  int max_station_count = min_station_count + config.election_day_length_hours_;
+  int min_station_count = this->GetMinStationCount(config);
+  int max_station_count = this->GetMaxStationCount(config);
 
   bool done_with_this_count = false;
   
@@ -322,72 +1035,398 @@ void OnePct::RunSimulationPct(const Configuration& config,
 
     done_with_this_count = true;
 
-    map<int, int> map_for_histo;
-
-    outstring = kTag + this->ToString() + "\n";
-    Utils::Output(outstring, out_stream, Utils::log_stream);
-    
-    for (int iteration = 0;
-         iteration < config.number_of_iterations_; ++iteration) {
-      //Calls CreateVoters
-      this->CreateVoters(config, random, out_stream);
-
-      voters_pending_ = voters_backup_;
-      voters_voting_.clear();
-      voters_done_voting_.clear();
+    //The last count, and any to be histogrammed, are always
+    //simulated; a screened count is sure to be too few.
+    if (config.prescreen_ && (stations_count < max_station_count) &&
+        (0 == stations_to_histo_.count(stations_count)) &&
+        this->ScreenStationCount(config, random, stations_count)) {
+      PctResult::StationStats screened;
+      screened.station_count = stations_count;
+      screened.screened = true;
+      result.stations_.push_back(screened);
+      done_with_this_count = false;
+      continue;
+    }
 
-      //Calls RunSimulationPct2 
-      this->RunSimulationPct2(stations_count);
-      
-      //Calls DoStatistics
-      int number_too_long = DoStatistics(iteration, config, stations_count,
-                                         map_for_histo, out_stream);
-      if (number_too_long > 0) {
+    PctResult::StationStats station = this->SimulateStationCount(config,
+                                                   random, stations_count);
+    for (auto stats = station.iterations.begin();
+              stats != station.iterations.end(); ++stats) {
+      if (stats->toolong_count > 0) {
         done_with_this_count = false;
       }
     }
 
+    station.has_histo = (stations_to_histo_.count(stations_count) > 0);
+    if (!station.has_histo)
+      station.histo.clear();
+    result.stations_.push_back(station);
+  }
+
+  if (config.prescreen_verify_)
+    this->VerifyPrescreen(config, result, random, exact_random);
+  return result;
+} // PctResult OnePct::ComputeResult
+
+/****************************************************************
+ * Function ScreenIteration
+ * Returns true if the voters in voters_backup_ are sure to have
+ * one who waits longer than 'too long' at 'stations_count'
+ * stations, worked out from their service demand a minute at a
+ * time rather than by simulating them second by second.
+ *
+ * The stations finish at most stations_count seconds of voting
+ * a second, so the work still to do at the end of a minute is
+ * at least the work at its start, plus the service demand of
+ * the voters who arrive in it, less 60*stations_count; 'backlog'
+ * is that bound, taken no lower than zero. Voters are served in
+ * order of arrival and every station is busy while one waits,
+ * so the first voter to arrive in a minute cannot start before
+ * the backlog ahead, less what is drained before it arrives,
+ * is down to what stations_count-1 voters already at a station
+ * can still have left, at most the longest service time each.
+ * The true waits are never shorter than this bound, so a count
+ * it screens out is one the full simulation would reject.
+**/
+bool OnePct::ScreenIteration(const Configuration& config,
+                             int stations_count) const {
+  if (voters_backup_.empty() || (voters_backup_.begin()->first < 0))
+    return false;
+
+  int last_minute = voters_backup_.rbegin()->first / 60;
+  vector<long long> demand_seconds(last_minute + 1, 0);
+  vector<int> first_arrival(last_minute + 1, -1);
+  long long longest_service = 0;
+  for (auto iter = voters_backup_.begin(); iter != voters_backup_.end();
+            ++iter) {
+    const OneVoter& voter = iter->second;
+    int minute = iter->first / 60;
+    long long service = voter.GetTimeDoneVoting() - voter.GetTimeArrival()
+                      - voter.GetTimeInQ();
+    demand_seconds[minute] += service;
+    if (first_arrival[minute] < 0)
+      first_arrival[minute] = iter->first;
+    longest_service = max(longest_service, service);
+  }
+
+  long long stations = stations_count;
+  long long in_service = (stations - 1) * longest_service;
+  long long too_long_seconds = 60LL
+                   * (config.wait_time_minutes_that_is_too_long_ + 1);
+  long long backlog = 0;
+  for (int minute = 0; minute <= last_minute; ++minute) {
+    if (first_arrival[minute] >= 0) {
+      long long ahead = backlog
+                      - stations * (first_arrival[minute] - 60 * minute);
+      if (ahead - in_service >= stations * too_long_seconds)
+        return true;
+    }
+    backlog = max(0LL, backlog + demand_seconds[minute] - 60 * stations);
+  }
+  return false;
+} // bool OnePct::ScreenIteration
+
+/****************************************************************
+ * Function ScreenStationCount
+ * Creates the voters of every iteration at 'stations_count', as
+ * SimulateStationCount would, and checks each with
+ * ScreenIteration(). If one is sure to have a voter who waits too
+ * long, the count is too few: 'random' is moved on past the
+ * voters, as the full simulation would have left it, and true is
+ * returned. Otherwise 'random' is left as it was, so that the
+ * full simulation draws the same voters, and false is returned.
+**/
+bool OnePct::ScreenStationCount(const Configuration& config,
+                                MyRandom& random, int stations_count) {
+  MyRandom probe = random;
+  MyRandom pair_start;
+  bool screened = false;
+
+  this->ClearVoterMaps();
+  ArenaScope arena_scope;
+  Arena& arena = arena_scope.GetArena();
+  for (int iteration = 0;
+       iteration < config.number_of_iterations_; ++iteration) {
+    this->ClearVoterMaps();
+    arena.Reset();
+    this->CreateIterationVoters(config, probe, iteration, pair_start);
+    if (!screened && this->ScreenIteration(config, stations_count))
+      screened = true;
+  }
+  this->ClearVoterMaps();
+
+  if (screened)
+    random = probe;
+  return screened;
+} // bool OnePct::ScreenStationCount
+
+/****************************************************************
+ * Function VerifyPrescreen
+ * Runs the search again from 'exact_random' with no prescreen
+ * and stops the run unless it tries the same station counts,
+ * finds the same statistics for each one 'result' simulated, and
+ * leaves the generator where 'random' is.
+**/
+void OnePct::VerifyPrescreen(const Configuration& config,
+                             const PctResult& result,
+                             const MyRandom& random,
+                             MyRandom& exact_random) {
+  Configuration exact_config = config;
+  exact_config.prescreen_ = false;
+  exact_config.prescreen_verify_ = false;
+  PctResult exact = this->ComputeResult(exact_config, exact_random);
+
+  bool agree = (exact.stations_.size() == result.stations_.size())
+            && (exact_random.ToStringState() == random.ToStringState());
+  for (size_t sub = 0; agree && (sub < result.stations_.size()); ++sub) {
+    PctResult screened_one;
+    PctResult exact_one;
+    screened_one.stations_.push_back(result.stations_[sub]);
+    exact_one.stations_.push_back(exact.stations_[sub]);
+    if (result.stations_[sub].screened) {
+      screened_one.stations_[0].screened = false;
+      exact_one.stations_[0].iterations.clear();
+      exact_one.stations_[0].has_histo = false;
+    }
+    agree = (screened_one.ToStringRecord() == exact_one.ToStringRecord());
+  }
+
+  if (!agree) {
+    cout << kTag << "ERROR PRESCREEN precinct " << pct_number_
+         << " chose " << result.stations_.back().station_count
+         << " stations but the full search chose "
+         << exact.stations_.back().station_count << endl;
+    exit(1);
+  }
+} // void OnePct::VerifyPrescreen
+
+/****************************************************************
+ * Function ComputeCurve
+ * Simulates every station count ComputeResult could try, from
+ * GetMinStationCount() to GetMaxStationCount(), rather than
+ * stopping at the first that is good enough, so that the result
+ * is the precinct's whole curve of wait against stations. It
+ * stops early only once no voter in any iteration waited at all,
+ * since more stations cannot do better than that. No histograms
+ * are kept.
+**/
+PctResult OnePct::ComputeCurve(const Configuration& config,
+                               MyRandom& random) {
+  PctResult curve;
+
+  for (int stations_count = this->GetMinStationCount(config);
+           stations_count <= this->GetMaxStationCount(config);
+           ++stations_count) {
+    PctResult::StationStats station = this->SimulateStationCount(config,
+                                                   random, stations_count);
+    station.histo.clear();
+
+    bool nobody_waited = true;
+    for (auto stats = station.iterations.begin();
+              stats != station.iterations.end(); ++stats) {
+      if (stats->wait_mean_seconds > 0.0)
+        nobody_waited = false;
+    }
+    curve.stations_.push_back(station);
+    if (nobody_waited)
+      break;
+  }
+  return curve;
+} // PctResult OnePct::ComputeCurve
+
+/****************************************************************
+ * Function SimulateStationCount
+ * Runs number_of_iterations_ iterations at one station count and
+ * returns their statistics with the histogram of waits summed
+ * over them. Each iteration creates voters, runs the day with
+ * RunSimulationPct2 and calls DoStatistics. With antithetic
+ * pairing, iterations 0 and 1, 2 and 3, and so on are pairs, and
+ * an odd last iteration has no partner. With a series file named
+ * the queue is also recorded minute by minute in station.series,
+ * and with either file's level at kVoters every iteration's voters
+ * are kept as text in station.voters.
+ * The voter maps live in this thread's arena for the duration,
+ * and its figures are kept in the statistics, as is the wall
+ * time the whole count took. A station count too big for
+ * OneVoter to hold stops the run.
+**/
+PctResult::StationStats OnePct::SimulateStationCount(const Configuration& config,
+                                                     MyRandom& random,
+                                                     int stations_count) {
+  if (stations_count > OneVoter::kMaxStationCount) {
+    cout << kTag << "ERROR precinct " << pct_number_ << " needs "
+         << stations_count << " stations; a voter holds at most "
+         << OneVoter::kMaxStationCount << endl;
+    exit(1);
+  }
+
+  auto started = chrono::steady_clock::now();
+  PctResult::StationStats station;
+  station.station_count = stations_count;
+  MyRandom pair_start;
+
+  //The voter maps draw from this thread's arena, which is emptied
+  //in one step before each iteration; they must be empty whenever
+  //it is, and when the scope ends.
+  this->ClearVoterMaps();
+  ArenaScope arena_scope;
+  Arena& arena = arena_scope.GetArena();
+
+  for (int iteration = 0;
+       iteration < config.number_of_iterations_; ++iteration) {
+    this->ClearVoterMaps();
+    arena.Reset();
+
+    this->CreateIterationVoters(config, random, iteration, pair_start);
+
+    voters_pending_ = voters_backup_;
     voters_voting_.clear();
     voters_done_voting_.clear();
 
-    outstring = kTag + "toolong space filler\n";
-    Utils::Output(outstring, out_stream, Utils::log_stream);
+    //Runs the day, with a kernel if one fits
+    QueueSeries* series = nullptr;
+    if (!config.series_filename_.empty()) {
+      if (station.series.IsEmpty())
+        station.series = QueueSeries(config.election_day_length_hours_ * 60);
+      station.series.StartIteration();
+      series = &station.series;
+    }
+    this->RunDay(config, stations_count, series);
+
+    if (!config.trace_filename_.empty()) {
+      station.trace += VoterTrace::EncodeIteration(pct_number_,
+                             stations_count, iteration, voters_done_voting_);
+    }
+
+    if (config.WantsVoters()) {
+      station.voters += ToStringVoterMap(kTag + "VOTERS "
+                             + Utils::Format(pct_number_, 4)
+                             + Utils::Format(stations_count, 4) + " stations"
+                             + " iteration " + Utils::Format(iteration, 4),
+                             voters_done_voting_);
+    }
+      
+    //Calls DoStatistics
+    PctResult::IterationStats stats = DoStatistics(iteration, config,
+                                                   station.histo);
+    station.iterations.push_back(stats);
+  }
+
+  this->ClearVoterMaps();
+  station.arena_bytes_allocated = arena.GetBytesAllocated();
+  station.arena_high_water_bytes = arena.GetHighWater();
+  station.wall_seconds = chrono::duration<double>(
+                             chrono::steady_clock::now() - started).count();
+  return station;
+} // PctResult::StationStats OnePct::SimulateStationCount
+
+/****************************************************************
+ * Function ReportResult
+ * Writes the lines for a result: for each station count, the
+ * precinct as a summary, then as detail one DoStatistics line
+ * per iteration, the 'toolong' filler and, if asked for, the
+ * histogram of waits, and the voters if they were kept. The
+ * labels come from this precinct, the numbers from 'result'.
+**/
+void OnePct::ReportResult(const PctResult& result,
+                          const Configuration& config, OutputSink& sink) {
+  LineFormat& line = LineFormat::ForThisThread();
+
+  for (auto iter = result.stations_.begin();
+            iter != result.stations_.end(); ++iter) {
+    int stations_count = iter->station_count;
+
+    line.Clear().Add(kTag);
+    this->FormatPct(line);
+    line.Add("\n");
 
-    if (stations_to_histo_.count(stations_count) > 0) {
-      outstring = "\n" + kTag + "HISTO " + this->ToString() + "\n";
-      outstring += kTag + "HISTO STATIONS "
-                + Utils::Format(stations_count, 4) + "\n";
-      Utils::Output(outstring, out_stream, Utils::log_stream);
+    if (iter->screened) {
+      line.Add(kTag).Add("SCREENED ").Add(pct_number_, 4)
+          .Add(stations_count, 4)
+          .Add(" stations, a voter is sure to wait over ")
+          .Add(config.wait_time_minutes_that_is_too_long_, 4).Add(" mins")
+          .Add(config.prescreen_verify_ ? ", verified\n" : "\n");
+    }
+    sink.Output(line.ToString());
+
+    line.Clear();
+    for (auto stats = iter->iterations.begin();
+              stats != iter->iterations.end(); ++stats) {
+      this->FormatStatistics(line, *stats, stations_count);
+    }
+
+    line.Add(kTag).Add("toolong space filler\n");
+
+    if (iter->has_histo) {
+      const map<int, int>& map_for_histo = iter->histo;
+
+      line.Add("\n").Add(kTag).Add("HISTO ");
+      this->FormatPct(line);
+      line.Add("\n").Add(kTag).Add("HISTO STATIONS ").Add(stations_count, 4)
+          .Add("\n");
 
       int time_lower = (map_for_histo.begin())->first;
       int time_upper = (map_for_histo.rbegin())->first;
 
       int voters_per_star = 1;
-      if (map_for_histo[time_lower] > 50) {
-        voters_per_star = map_for_histo[time_lower]/(50 * config.number_of_iterations_);
+      if (map_for_histo.begin()->second > 50) {
+        voters_per_star = map_for_histo.begin()->second
+                        / (50 * config.number_of_iterations_);
         if (voters_per_star <= 0)
           voters_per_star = 1;
       }
 
+      auto next = map_for_histo.begin();
       for (int time = time_lower; time <= time_upper; ++time) {
-        int count = map_for_histo[time];
+        int count = 0;
+        if ((map_for_histo.end() != next) && (time == next->first)) {
+          count = next->second;
+          ++next;
+        }
 
         double count_double = static_cast<double>(count) /
         static_cast<double>(config.number_of_iterations_);
 
         int count_divided_ceiling = static_cast<int>(ceil(count_double/voters_per_star));
-        string stars = string(count_divided_ceiling, '*');
 
-        outstring = kTag + "HISTO " + Utils::Format(time, 6) + ": "
-                         + Utils::Format(count_double, 7, 2) + ": ";
-        outstring += stars + "\n";
-        Utils::Output(outstring, out_stream, Utils::log_stream);
+        line.Add(kTag).Add("HISTO ").Add(time, 6).Add(": ")
+            .Add(count_double, 7, 2).Add(": ")
+            .AddRepeat('*', count_divided_ceiling).Add("\n");
       }
-      outstring = "HISTO\n\n";
-      Utils::Output(outstring, out_stream, Utils::log_stream);
+      line.Add("HISTO\n\n");
+    }
+    sink.Output(line.ToString(), OutputSink::kDetail);
+
+    if (!iter->voters.empty())
+      sink.Output(iter->voters, OutputSink::kVoters);
+
+    if (!iter->series.IsEmpty() && (iter + 1 == result.stations_.end())) {
+      sink.Output(iter->series.ToStringHourly(kTag + "SERIES "
+                          + Utils::Format(stations_count, 4) + " stations "),
+                  OutputSink::kDetail);
+    }
+
+    if ((config.antithetic_ || config.control_variates_) && !iter->screened) {
+      sink.Output(kTag + "VARRED " + this->ToStringVarianceReduction(*iter,
+                                                               config) + "\n",
+                  OutputSink::kDetail);
     }
   }
-} //void RunSimulationPct
+
+  if (config.arena_stats_) {
+    long long allocated = 0;
+    long long high_water = 0;
+    for (auto iter = result.stations_.begin();
+              iter != result.stations_.end(); ++iter) {
+      allocated += iter->arena_bytes_allocated;
+      high_water = max(high_water, iter->arena_high_water_bytes);
+    }
+    sink.Output(kTag + "ARENA " + Utils::Format(pct_number_, 4)
+                + " bytes allocated " + Utils::Format((double)allocated, 12, 0)
+                + " high water " + Utils::Format((double)high_water, 10, 0)
+                + "\n", OutputSink::kDetail);
+  }
+} // void OnePct::ReportResult
 
 /****************************************************************
 * Function RunSimulationPct2
@@ -401,11 +1440,29 @@ void OnePct::RunSimulationPct(const Configuration& config,
 * map. This continues on a second by second basis until there are
 * no more voters voting or waiting to vote.
 * } endReeser
+* The seconds in which no voter can finish or start are skipped,
+* which changes nothing about the voters done. If 'series' is not
+* null each second's queue length, voters in service and stations
+* open are recorded in it, the skipped ones a span at a time.
 **/
-void OnePct::RunSimulationPct2(int stations_count) {
+void OnePct::RunSimulationPct2(int stations_count, QueueSeries* series) {
 
   //clears free_stations_ from any previous simulations
   free_stations_.clear();
+
+  //for the series, the voters who have arrived are counted off
+  //a sorted list of arrival times, and those who have started
+  //voting are counted as they are assigned
+  vector<int> arrival_times;
+  int arrived_count = 0;
+  int started_count = 0;
+  if (nullptr != series) {
+    arrival_times.reserve(voters_pending_.size());
+    for (auto iter = voters_pending_.begin(); iter != voters_pending_.end();
+              ++iter) {
+      arrival_times.push_back(iter->first);
+    }
+  }
   
   //pushes back once for every stations_count
   for (int i = 0; i < stations_count; ++i) {
@@ -432,7 +1489,7 @@ void OnePct::RunSimulationPct2(int stations_count) {
     //erases all the voters who just finished voting
     voters_voting_.erase(second);
 
-    vector<map<int, OneVoter>::iterator > voters_pending_to_erase_by_iterator;
+    vector<VoterMap::iterator> voters_pending_to_erase_by_iterator;
       for (auto iter = voters_pending_.begin(); iter != voters_pending_.end(); ++iter) {
         if (second >= iter->first) {       // if they have already arrived
           if (free_stations_.size() > 0) { // and there are free stations
@@ -444,6 +1501,7 @@ void OnePct::RunSimulationPct2(int stations_count) {
               int leave_time = next_voter.GetTimeDoneVoting();
               voters_voting_.insert(std::pair<int, OneVoter>(leave_time, next_voter));
               voters_pending_to_erase_by_iterator.push_back(iter);
+              ++started_count;
 
 // This was commented out 6 October 2016
 //            Utils::log_stream << kTag << "ASSIGNED    "
@@ -468,7 +1526,33 @@ Utils::log_stream << kTag << "PENDING, VOTING, DONE    "
                 iter != voters_pending_to_erase_by_iterator.end(); ++iter) {
         voters_pending_.erase(*iter);
       }
-      ++second;
+
+      //skips to the next second in which a voter finishes or, with a
+      //station free, one can start; the series is given this second
+      //and those skipped as spans, split where voters arrive and join
+      //the queue
+      int next_second = INT_MAX;
+      if (!voters_voting_.empty())
+        next_second = voters_voting_.begin()->first;
+      if (!free_stations_.empty() && !voters_pending_.empty())
+        next_second = min(next_second, voters_pending_.begin()->first);
+      if (INT_MAX == next_second)
+        next_second = second + 1;
+      next_second = max(second + 1, next_second);
+      while ((nullptr != series) && (second < next_second)) {
+        while ((arrived_count < static_cast<int>(arrival_times.size())) &&
+               (arrival_times[arrived_count] <= second)) {
+          ++arrived_count;
+        }
+        int span_end = next_second;
+        if (arrived_count < static_cast<int>(arrival_times.size()))
+          span_end = min(span_end, arrival_times[arrived_count]);
+        series->RecordSpan(second, span_end, arrived_count - started_count,
+                           static_cast<int>(voters_voting_.size()),
+                           stations_count);
+        second = span_end;
+      }
+      second = next_second;
 //    if (second > 500) break;
       done = true;
       
@@ -481,40 +1565,534 @@ Utils::log_stream << kTag << "PENDING, VOTING, DONE    "
   } // void Simulation::RunSimulationPct2()
 
 /****************************************************************
- * Function ToString
- * Returns a string containing the pct_number_, pct_name_, pct_turnout_,
- *   pct_num_voters_, pct_expected_voters_, pct_expected_per_hour_,
- *   pct_minority_, and pct_minority_
- *   It also creates a histogram for the precinct.
+ * Function RunSimulationKernel
+ * Runs the day as RunSimulationPct2 does, for at most kMaxStations
+ * stations. The state is in fixed-size arrays: each station's
+ * voter and the second it finishes (INT_MAX when free, or past
+ * stations_count), and a ring of free stations,
+ * taken from the front and given back at the back as the vector
+ * in RunSimulationPct2 is. Waiting voters are taken from the front
+ * of voters_pending_, which is how RunSimulationPct2 takes them.
+ * Voters who finish in the same second are handed on in the order
+ * they started, as the voters_voting_ map would give them, and the
+ * seconds in which nothing can happen are skipped, as they are
+ * there, so the voters done, their stations and their order are
+ * just the same, and so is the series when there is one.
 **/
-  string OnePct::ToString() {
-  string s = "";
+template <size_t kMaxStations>
+void OnePct::RunSimulationKernel(int stations_count, QueueSeries* series) {
+  static_assert(0 == (kMaxStations & (kMaxStations - 1)),
+                "the ring of free stations needs a power of two");
+  array<OneVoter, kMaxStations> serving;
+  array<int, kMaxStations> finish_second;
+  array<int, kMaxStations> start_order;
+  array<int, kMaxStations> free_ring;
+  size_t ring_front = 0;
+  size_t ring_size = 0;
+
+  for (size_t station = 0; station < kMaxStations; ++station) {
+    finish_second[station] = INT_MAX;
+    start_order[station] = 0;
+    if (static_cast<int>(station) < stations_count)
+      free_ring[ring_size++] = static_cast<int>(station);
+  }
+
+  voters_voting_.clear();
+  voters_done_voting_.clear();
+  auto next_voter = voters_pending_.begin();
+  auto next_arrival = voters_pending_.begin();
+  int arrived_count = 0;
+  int busy_count = 0;
+  int started_count = 0;
+
+  int second = 0;
+  while (true) {
+    //hands on the voters who finish now, in the order they started
+    if (busy_count > 0) {
+      array<int, kMaxStations> finishing;
+      size_t finishing_count = 0;
+      for (size_t station = 0; station < kMaxStations; ++station) {
+        if (second == finish_second[station]) {
+          size_t sub = finishing_count++;
+          while ((sub > 0) &&
+                 (start_order[finishing[sub - 1]] > start_order[station])) {
+            finishing[sub] = finishing[sub - 1];
+            --sub;
+          }
+          finishing[sub] = static_cast<int>(station);
+        }
+      }
+      for (size_t sub = 0; sub < finishing_count; ++sub) {
+        int station = finishing[sub];
+        free_ring[(ring_front + ring_size++) & (kMaxStations - 1)] = station;
+        voters_done_voting_.emplace_hint(voters_done_voting_.end(), second,
+                                         serving[station]);
+        finish_second[station] = INT_MAX;
+        --busy_count;
+      }
+    }
+
+    //starts the voters who have arrived, while stations are free
+    while ((ring_size > 0) && (next_voter != voters_pending_.end()) &&
+           (next_voter->first <= second)) {
+      int station = free_ring[ring_front];
+      ring_front = (ring_front + 1) & (kMaxStations - 1);
+      --ring_size;
+      OneVoter voter = next_voter->second;
+      voter.AssignStation(station, second);
+      serving[station] = voter;
+      finish_second[station] = voter.GetTimeDoneVoting();
+      start_order[station] = started_count++;
+      ++busy_count;
+      ++next_voter;
+    }
+
+    //the next second in which a voter finishes or starts, or the
+    //next one if the day is over
+    int next_second = INT_MAX;
+    for (size_t station = 0; station < kMaxStations; ++station) {
+      next_second = min(next_second, finish_second[station]);
+    }
+    if ((ring_size > 0) && (voters_pending_.end() != next_voter))
+      next_second = min(next_second, next_voter->first);
+    if (INT_MAX == next_second)
+      next_second = second + 1;
+    next_second = max(second + 1, next_second);
+
+    //this second and those skipped go to the series as spans, split
+    //where voters arrive and join the queue
+    while ((nullptr != series) && (second < next_second)) {
+      while ((voters_pending_.end() != next_arrival) &&
+             (next_arrival->first <= second)) {
+        ++next_arrival;
+        ++arrived_count;
+      }
+      int span_end = next_second;
+      if (voters_pending_.end() != next_arrival)
+        span_end = min(span_end, next_arrival->first);
+      series->RecordSpan(second, span_end, arrived_count - started_count,
+                         busy_count, stations_count);
+      second = span_end;
+    }
+
+    if ((voters_pending_.end() == next_voter) && (0 == busy_count))
+      break;
+    second = next_second;
+  }
 
-  s += Utils::Format(pct_number_, 4);
-  s += " " + Utils::Format(pct_name_, 25, "left");
-  s += Utils::Format(pct_turnout_, 8, 2);
-  s += Utils::Format(pct_num_voters_, 8);
-  s += Utils::Format(pct_expected_voters_, 8);
-  s += Utils::Format(pct_expected_per_hour_, 8);
-  s += Utils::Format(pct_stations_, 3);
-  s += Utils::Format(pct_minority_, 8, 2);
+  voters_pending_.clear();
+  free_stations_.clear();
+  for (size_t sub = 0; sub < ring_size; ++sub) {
+    free_stations_.push_back(free_ring[(ring_front + sub) & (kMaxStations - 1)]);
+  }
+} // void OnePct::RunSimulationKernel
+
+/****************************************************************
+ * Function RunSimulationKernels
+ * Runs the day with the smallest kernel that has room for
+ * 'stations_count' stations and returns true, or returns false if
+ * none has.
+**/
+bool OnePct::RunSimulationKernels(int stations_count, QueueSeries* series) {
+  if (stations_count <= 4)
+    this->RunSimulationKernel<4>(stations_count, series);
+  else if (stations_count <= 8)
+    this->RunSimulationKernel<8>(stations_count, series);
+  else if (stations_count <= 16)
+    this->RunSimulationKernel<16>(stations_count, series);
+  else if (stations_count <= 32)
+    this->RunSimulationKernel<32>(stations_count, series);
+  else
+    return false;
+  return true;
+}
+
+/****************************************************************
+ * Function RunDay
+ * Runs the day from voters_pending_, with a kernel when kernels
+ * are on and one has room for the stations, and with
+ * RunSimulationPct2 otherwise.
+**/
+void OnePct::RunDay(const Configuration& config, int stations_count,
+                    QueueSeries* series) {
+  if (config.kernels_ && this->RunSimulationKernels(stations_count, series))
+    return;
+  this->RunSimulationPct2(stations_count, series);
+}
+
+/****************************************************************
+ * Function RunSimulationSchedule
+ * Runs the day as RunSimulationPct2 does, but with schedule[h]
+ * stations open in hour 'h' (the last count stays open after
+ * the polls close), and returns the seconds it simulated.
+ *
+ * At the start of each hour, before that hour's count takes
+ * effect, the queue is saved as snapshots[h]. With 'resume_hour'
+ * zero the day starts from voters_backup_; otherwise it starts
+ * from snapshots[resume_hour], which must have been saved by a
+ * run whose schedule agrees with this one before that hour, and
+ * the later snapshots are replaced by this run's.
+ *
+ * When the count drops, a station in use finishes its voter and
+ * then closes; when it rises, only stations not in use open.
+**/
+int OnePct::RunSimulationSchedule(const vector<int>& schedule, int resume_hour,
+                                  vector<QueueState>& snapshots) {
+  int hours = static_cast<int>(schedule.size());
+  int second = 0;
+  int stations_count = 0;
+
+  if (resume_hour > 0) {
+    const QueueState& state = snapshots.at(resume_hour);
+    stations_count = state.stations_count;
+    free_stations_ = state.free_stations;
+    voters_done_voting_ = state.voters_done_voting;
+    voters_pending_ = state.voters_pending;
+    voters_voting_ = state.voters_voting;
+    snapshots.resize(resume_hour + 1);
+    second = resume_hour * 3600;
+  }
+  else {
+    free_stations_.clear();
+    voters_pending_ = voters_backup_;
+    voters_voting_.clear();
+    voters_done_voting_.clear();
+    snapshots.clear();
+  }
+  int first_second = second;
+
+  bool done = false;
+  while (!done) {
+    int hour = second / 3600;
+    if ((0 == second % 3600) && (hour < hours)) {
+      if (static_cast<int>(snapshots.size()) == hour) {
+        QueueState state;
+        state.stations_count = stations_count;
+        state.free_stations = free_stations_;
+        state.voters_done_voting = voters_done_voting_;
+        state.voters_pending = voters_pending_;
+        state.voters_voting = voters_voting_;
+        snapshots.push_back(state);
+      }
 
-  s += " HH ";
+      int new_count = schedule.at(hour);
+      if (new_count < stations_count) {
+        vector<int> still_open;
+        for (auto iter = free_stations_.begin();
+                  iter != free_stations_.end(); ++iter) {
+          if (*iter < new_count)
+            still_open.push_back(*iter);
+        }
+        free_stations_ = still_open;
+      }
+      for (int station = stations_count; station < new_count; ++station) {
+        bool in_use = false;
+        for (auto iter = voters_voting_.begin();
+                  iter != voters_voting_.end(); ++iter) {
+          if (station == iter->second.GetStationNumber())
+            in_use = true;
+        }
+        if (!in_use)
+          free_stations_.push_back(station);
+      }
+      stations_count = new_count;
+    }
+
+    // Voters who are done go to voters_done_voting_, and their
+    // stations are free again unless they have since closed.
+    for (auto iter = voters_voting_.begin(); iter != voters_voting_.end();
+              ++iter) {
+      if (second == iter->first) {
+        OneVoter one_voter = iter->second;
+        int which_station = one_voter.GetStationNumber();
+        if (which_station < stations_count)
+          free_stations_.push_back(which_station);
+        voters_done_voting_.insert(std::pair<int, OneVoter>(second, one_voter));
+      }
+    }
+    voters_voting_.erase(second);
+
+    // Voters who have arrived take free stations in arrival order.
+    vector<VoterMap::iterator> voters_pending_to_erase_by_iterator;
+    for (auto iter = voters_pending_.begin(); iter != voters_pending_.end();
+              ++iter) {
+      if (second < iter->first)
+        break;
+      if (free_stations_.empty())
+        break;
+      OneVoter next_voter = iter->second;
+      int which_station = free_stations_.at(0);
+      free_stations_.erase(free_stations_.begin());
+      next_voter.AssignStation(which_station, second);
+      int leave_time = next_voter.GetTimeDoneVoting();
+      voters_voting_.insert(std::pair<int, OneVoter>(leave_time, next_voter));
+      voters_pending_to_erase_by_iterator.push_back(iter);
+    }
+    for (auto iter = voters_pending_to_erase_by_iterator.begin();
+              iter != voters_pending_to_erase_by_iterator.end(); ++iter) {
+      voters_pending_.erase(*iter);
+    }
+    ++second;
+
+    done = voters_pending_.empty() && voters_voting_.empty();
+  }
+  return second - first_second;
+} // int OnePct::RunSimulationSchedule
+
+/****************************************************************
+ * Function FormatPct
+ * Appends the pct_number_, pct_name_, pct_turnout_,
+ *   pct_num_voters_, pct_expected_voters_, pct_expected_per_hour_,
+ *   pct_stations_ and pct_minority_, then the station counts to
+ *   be histogrammed, as ToString() returns them.
+**/
+void OnePct::FormatPct(LineFormat& line) const {
+  line.Add(pct_number_, 4).Add(" ").AddLeft(pct_name_, 25)
+      .Add(pct_turnout_, 8, 2)
+      .Add(pct_num_voters_, 8)
+      .Add(pct_expected_voters_, 8)
+      .Add(pct_expected_per_hour_, 8)
+      .Add(pct_stations_, 3)
+      .Add(pct_minority_, 8, 2);
+
+  line.Add(" HH ");
   for (auto iter = stations_to_histo_.begin();
             iter != stations_to_histo_.end(); ++iter) {
-    s += Utils::Format(*iter, 4);
+    line.Add(*iter, 4);
   }
-  s += " HH";
+  line.Add(" HH");
+}
 
-  return s;
+/****************************************************************
+ * Function ToString
+ * Returns the line FormatPct() writes.
+**/
+string OnePct::ToString() {
+  LineFormat line;
+  this->FormatPct(line);
+  return line.ToString();
 } // string OnePct::ToString()
 
+/****************************************************************
+ * Function FormatStatistics
+ * Appends the DoStatistics line for one iteration: mean and
+ * deviation of the wait in minutes, then the count and percent
+ * of voters who waited too long, too long plus 10 and too long
+ * plus 20 minutes.
+**/
+void OnePct::FormatStatistics(LineFormat& line,
+                              const PctResult::IterationStats& stats,
+                              int station_count) const {
+  double voters = static_cast<double>(pct_expected_voters_);
+  line.Add(kTag).Add(stats.iteration, 3).Add(" ")
+      .Add(pct_number_, 4).Add(" ")
+      .AddLeft(pct_name_, 25)
+      .Add(pct_expected_voters_, 6)
+      .Add(station_count, 4)
+      .Add(" stations, mean/dev wait (mins) ")
+      .Add(stats.wait_mean_seconds/60.0, 8, 2).Add(" ")
+      .Add(stats.wait_dev_seconds/60.0, 8, 2).Add(" toolong ")
+      .Add(stats.toolong_count, 6).Add(" ")
+      .Add(100.0*stats.toolong_count/voters, 6, 2)
+      .Add(stats.toolong_count_plus10, 6).Add(" ")
+      .Add(100.0*stats.toolong_count_plus10/voters, 6, 2)
+      .Add(stats.toolong_count_plus20, 6).Add(" ")
+      .Add(100.0*stats.toolong_count_plus20/voters, 6, 2)
+      .Add("\n");
+} // void OnePct::FormatStatistics
+
+/****************************************************************
+ * Function ReducedMean
+ * Estimates the mean of 'units' and the variance of that
+ * estimate. If control means are given, the units are first
+ * regressed on the controls by least squares and the estimate is
+ * moved by the fitted slopes times how far the controls' average
+ * fell from their means. A control that does not vary, or that
+ * the units are too few to fit, is dropped. Returns false if
+ * there are fewer than two units.
+**/
+static bool ReducedMean(const vector<double>& units,
+                        const vector<vector<double> >& controls,
+                        const vector<double>& control_means,
+                        double& estimate, double& variance) {
+  int count = static_cast<int>(units.size());
+  if (count < 2)
+    return false;
+
+  double units_mean = 0.0;
+  for (int sub = 0; sub < count; ++sub) {
+    units_mean += units.at(sub);
+  }
+  units_mean /= count;
+
+  // Centred sums of squares and products of the usable controls.
+  vector<int> used;
+  vector<double> means;
+  for (UINT control = 0; control < controls.size(); ++control) {
+    double mean = 0.0;
+    for (int sub = 0; sub < count; ++sub) {
+      mean += controls.at(control).at(sub);
+    }
+    mean /= count;
+    double spread = 0.0;
+    for (int sub = 0; sub < count; ++sub) {
+      double deviation = controls.at(control).at(sub) - mean;
+      spread += deviation * deviation;
+    }
+    if ((spread > 0.0) && (count > static_cast<int>(used.size()) + 2)) {
+      used.push_back(control);
+      means.push_back(mean);
+    }
+  }
+
+  double syy = 0.0;
+  double sc[2][2] = { { 0.0, 0.0 }, { 0.0, 0.0 } };
+  double scy[2] = { 0.0, 0.0 };
+  for (int sub = 0; sub < count; ++sub) {
+    double dy = units.at(sub) - units_mean;
+    syy += dy * dy;
+    for (UINT row = 0; row < used.size(); ++row) {
+      double dr = controls.at(used.at(row)).at(sub) - means.at(row);
+      scy[row] += dr * dy;
+      for (UINT col = 0; col < used.size(); ++col) {
+        sc[row][col] += dr * (controls.at(used.at(col)).at(sub) - means.at(col));
+      }
+    }
+  }
+
+  // Two controls that move together are fitted as one.
+  if (2 == used.size()) {
+    double det = sc[0][0] * sc[1][1] - sc[0][1] * sc[1][0];
+    if (det <= 1.0e-12 * sc[0][0] * sc[1][1])
+      used.pop_back();
+  }
+
+  double slope[2] = { 0.0, 0.0 };
+  if (1 == used.size()) {
+    slope[0] = scy[0] / sc[0][0];
+  }
+  else if (2 == used.size()) {
+    double det = sc[0][0] * sc[1][1] - sc[0][1] * sc[1][0];
+    slope[0] = (sc[1][1] * scy[0] - sc[0][1] * scy[1]) / det;
+    slope[1] = (sc[0][0] * scy[1] - sc[1][0] * scy[0]) / det;
+  }
+
+  estimate = units_mean;
+  double residual = syy;
+  for (UINT row = 0; row < used.size(); ++row) {
+    estimate -= slope[row] * (means.at(row) - control_means.at(used.at(row)));
+    residual -= slope[row] * scy[row];
+  }
+  int freedom = count - 1 - static_cast<int>(used.size());
+  variance = max(0.0, residual) / freedom / count;
+  return true;
+} // static bool ReducedMean
+
+/****************************************************************
+ * Function ToStringVarianceReduction
+ * Returns, for the mean wait and the mean toolong count at one
+ * station count, the plain mean over the iterations with its
+ * standard error, the reduced estimate with its standard error,
+ * the effective sample size (how many independent iterations
+ * would give the reduced estimate's variance) and the gain, the
+ * effective size over the iterations actually run. The units are
+ * antithetic pairs if pairing is on, otherwise iterations.
+**/
+string OnePct::ToStringVarianceReduction(const PctResult::StationStats& station,
+                                         const Configuration& config) const {
+  const vector<PctResult::IterationStats>& iterations = station.iterations;
+  int count = static_cast<int>(iterations.size());
+  int step = config.antithetic_ ? 2 : 1;
+
+  vector<double> control_means(2, 0.0);
+  this->ExpectedControls(config, control_means.at(0), control_means.at(1));
+
+  vector<double> plain_waits;
+  vector<double> plain_toolongs;
+  vector<double> unit_waits;
+  vector<double> unit_toolongs;
+  vector<vector<double> > controls(2);
+  for (int sub = 0; sub < count; ++sub) {
+    plain_waits.push_back(iterations.at(sub).wait_mean_seconds / 60.0);
+    plain_toolongs.push_back(iterations.at(sub).toolong_count);
+  }
+  for (int sub = 0; sub + step <= count; sub += step) {
+    double wait = 0.0;
+    double toolong = 0.0;
+    double service_demand = 0.0;
+    double arrival_sum = 0.0;
+    for (int member = sub; member < sub + step; ++member) {
+      wait += iterations.at(member).wait_mean_seconds / 60.0;
+      toolong += iterations.at(member).toolong_count;
+      service_demand += iterations.at(member).service_demand_seconds;
+      arrival_sum += iterations.at(member).arrival_sum_seconds;
+    }
+    unit_waits.push_back(wait / step);
+    unit_toolongs.push_back(toolong / step);
+    controls.at(0).push_back(service_demand / step);
+    controls.at(1).push_back(arrival_sum / step);
+  }
+  if (!config.control_variates_)
+    controls.clear();
+
+  string s = "stations " + Utils::Format(station.station_count, 4)
+           + " units " + Utils::Format(static_cast<int>(unit_waits.size()), 4);
+
+  const vector<double>* plains[2] = { &plain_waits, &plain_toolongs };
+  const vector<double>* units[2] = { &unit_waits, &unit_toolongs };
+  const string labels[2] = { " wait (mins)", " toolong" };
+  for (int measure = 0; measure < 2; ++measure) {
+    double plain = 0.0;
+    double plain_variance = 0.0;
+    double reduced = 0.0;
+    double reduced_variance = 0.0;
+    s += labels[measure];
+    if (!ReducedMean(*plains[measure], vector<vector<double> >(),
+                     vector<double>(), plain, plain_variance) ||
+        !ReducedMean(*units[measure], controls, control_means,
+                     reduced, reduced_variance)) {
+      s += " n/a";
+      continue;
+    }
+
+    s += " plain " + Utils::Format(plain, 8, 2)
+       + " se " + Utils::Format(sqrt(plain_variance), 7, 3)
+       + " reduced " + Utils::Format(reduced, 8, 2)
+       + " se " + Utils::Format(sqrt(reduced_variance), 7, 3);
+    if (reduced_variance > 0.0) {
+      double effective = plain_variance * count / reduced_variance;
+      s += " ess " + Utils::Format(effective, 8, 1)
+         + " gain " + Utils::Format(effective / count, 6, 2);
+    }
+    else {
+      s += " ess      n/a gain    n/a";
+    }
+  }
+  return s;
+} // string OnePct::ToStringVarianceReduction
+
+/****************************************************************
+ * Function ToStringWorkload
+ * Returns the inputs that the precinct's simulation depends on:
+ * the expected voters and the station counts to histogram. Two
+ * precincts with the same workload and the same RN stream get
+ * the same PctResult.
+**/
+string OnePct::ToStringWorkload() const {
+  string s = "voters " + to_string(pct_expected_voters_) + " histo";
+  for (auto iter = stations_to_histo_.begin();
+            iter != stations_to_histo_.end(); ++iter) {
+    s += " " + to_string(*iter);
+  }
+  return s;
+} // string OnePct::ToStringWorkload
+
 /****************************************************************
  * Function ToStringVoterMap
  * Returns a string containing all the voter information 
 **/
 string OnePct::ToStringVoterMap(string label,
-               multimap<int, OneVoter> themap) {
+               const VoterMap& themap) {
   string s = "";
 
   s += "\n" + label + " WITH " + Utils::Format((int)themap.size(), 6)
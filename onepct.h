@@ -44,9 +44,16 @@
 
 using namespace std;
 
+#include "arrivalplan.h"
 #include "configuration.h"
+#include "fastscanner.h"
+#include "lineformat.h"
 #include "myrandom.h"
 #include "onevoter.h"
+#include "outputsink.h"
+#include "pctresult.h"
+#include "queueseries.h"
+#include "votertrace.h"
 
 static const double kDummyDouble = -88.88;
 static const int kDummyInt = -999;
@@ -63,19 +70,53 @@ public:
 
 /****************************************************************
  * Accessors to return the expected number of voters for a
- * precinct and a precint's number.
+ * precinct, a precint's number and registered voters, the range of station
+ * counts that RunSimulationPct tries. The mutator sets the
+ * expected voters for a what-if precinct.
 **/
   int GetExpectedVoters() const;
+  int GetMaxStationCount(const Configuration& config) const;
+  int GetMinStationCount(const Configuration& config) const;
   int GetPctNumber() const;
+  int GetRegisteredVoters() const;
+  void SetExpectedVoters(int expected_voters);
 
 /****************************************************************
- * General functions.
+ * General functions. RunSimulationPct() is ComputeResult(), which
+ * simulates, followed by ReportResult(), which writes the lines.
+ * They can be called apart when a result is already known.
+ * ComputeCurve() simulates the whole range of station counts.
+ * RunArrivalsCheck() tests the order statistics arrivals against
+ * the chain of gaps.
+ * RunKernelBench() times the specialised kernels against the
+ * general loops. RunSchedules() simulates and reports the
+ * configuration's hour-by-hour station schedules.
+ * RunToolongSweep() reports several 'too long' waits from one
+ * simulation, and returns that simulation's result.
 **/
   void ReadData(Scanner& infile);
-  void RunSimulationPct(const Configuration& config, MyRandom& random, ofstream& out_stream);
+  void ReadData(FastScanner& infile);
+  PctResult ComputeCurve(const Configuration& config, MyRandom& random);
+  PctResult ComputeResult(const Configuration& config, MyRandom& random);
+  void ReportResult(const PctResult& result, const Configuration& config,
+                    OutputSink& sink);
+  void RunSimulationPct(const Configuration& config, MyRandom& random,
+                        OutputSink& sink);
+  void RunArrivalsCheck(const Configuration& config, MyRandom& random,
+                        OutputSink& sink, int& differ);
+  void RunKernelBench(const Configuration& config, MyRandom& random,
+                      OutputSink& sink, double& generic_ms, double& kernel_ms);
+  void RunSchedules(const Configuration& config, MyRandom& random,
+                    OutputSink& sink);
+  PctResult RunToolongSweep(const Configuration& config, MyRandom& random,
+                            OutputSink& sink);
+  PctResult::StationStats SimulateStationCount(const Configuration& config,
+                                               MyRandom& random,
+                                               int stations_count);
 
   string ToString();
-  string ToStringVoterMap(string label, multimap<int, OneVoter> themap);
+  string ToStringWorkload() const;
+  string ToStringVoterMap(string label, const VoterMap& themap);
   //formats output for various maps
 
 private:
@@ -91,25 +132,72 @@ private:
   double wait_mean_seconds_;
   set<int> stations_to_histo_;
   vector<int> free_stations_;
+  shared_ptr<const ArrivalPlan> arrival_plan_;
 
   //multimaps used to dynamically store voters
-  multimap<int, OneVoter> voters_backup_;
-  multimap<int, OneVoter> voters_done_voting_;
-  multimap<int, OneVoter> voters_pending_;
-  multimap<int, OneVoter> voters_voting_;
+  VoterMap voters_backup_;
+  VoterMap voters_done_voting_;
+  VoterMap voters_pending_;
+  VoterMap voters_voting_;
+
+/****************************************************************
+ * The state of the queue at the start of an hour, before that
+ * hour's station count takes effect, kept so that a schedule
+ * that agrees with an earlier one up to that hour can start
+ * there instead of at second zero.
+**/
+  struct QueueState {
+    int stations_count = 0;
+    vector<int> free_stations;
+    VoterMap voters_done_voting;
+    VoterMap voters_pending;
+    VoterMap voters_voting;
+  };
 
 /****************************************************************
  * General private functions. Used to create voters within a
  * precinct and to compute the mean waiting time and the standard
- * deviation among waiting times for a precinct.
+ * deviation among waiting times for a precinct. The Screen and
+ * Verify functions are the prescreen ComputeResult() uses.
+ * GetArrivalPlan() returns the shared plan the voters are created
+ * from, keeping it in arrival_plan_ while it still fits.
 **/
-  void CreateVoters(const Configuration& config, MyRandom& random,
-                    ofstream& out_stream);
-  int DoStatistics(int iteration, const Configuration& config, int station_count,
-                   map<int, int>& map_for_histo, ofstream& out_stream);
+  void ClearVoterMaps();
+  const ArrivalPlan& GetArrivalPlan(const Configuration& config);
+  void CreateIterationVoters(const Configuration& config, MyRandom& random,
+                             int iteration, MyRandom& pair_start);
+  void CreateVoters(const Configuration& config, MyRandom& random);
+  template <int kHours>
+  void CreateVotersKernel(const Configuration& config, MyRandom& random);
+  void CreateVotersOrdered(const Configuration& config, MyRandom& random);
+  PctResult::IterationStats DoStatistics(int iteration,
+                                         const Configuration& config,
+                                         map<int, int>& map_for_histo);
+  void FormatPct(LineFormat& line) const;
+  void FormatStatistics(LineFormat& line,
+                        const PctResult::IterationStats& stats,
+                        int station_count) const;
+  void ExpectedControls(const Configuration& config,
+                        double& service_demand_seconds,
+                        double& arrival_sum_seconds) const;
+  bool ScreenIteration(const Configuration& config,
+                       int stations_count) const;
+  bool ScreenStationCount(const Configuration& config, MyRandom& random,
+                          int stations_count);
+  void VerifyPrescreen(const Configuration& config, const PctResult& result,
+                       const MyRandom& random, MyRandom& exact_random);
+  string ToStringVarianceReduction(const PctResult::StationStats& station,
+                                   const Configuration& config) const;
 
   void ComputeMeanAndDev();
-  void RunSimulationPct2(int stations);
+  void RunDay(const Configuration& config, int stations_count,
+              QueueSeries* series);
+  void RunSimulationPct2(int stations, QueueSeries* series);
+  template <size_t kMaxStations>
+  void RunSimulationKernel(int stations_count, QueueSeries* series);
+  bool RunSimulationKernels(int stations_count, QueueSeries* series);
+  int RunSimulationSchedule(const vector<int>& schedule, int resume_hour,
+                            vector<QueueState>& snapshots);
 
 };
 
@@ -28,7 +28,7 @@ OneVoter::OneVoter(int sequence, int arrival_seconds,
   sequence_ = sequence;
   time_arrival_seconds_ = arrival_seconds;
   time_start_voting_seconds_ = 0;
-  time_vote_duration_seconds_ = duration_seconds;
+  time_vote_duration_seconds_ = static_cast<uint16_t>(duration_seconds);
   which_station_ = -1;
 }
 
@@ -52,7 +52,16 @@ int OneVoter::GetTimeArrival() const {
  * before being served at a service station.
 **/
 int OneVoter::GetTimeWaiting() const {
-  return time_waiting_seconds_;
+  return time_start_voting_seconds_ - time_arrival_seconds_;
+}
+
+/****************************************************************
+ * Function GetSequence
+ *
+ * Returns the number the voter was given when created.
+**/
+int OneVoter::GetSequence() const {
+  return sequence_;
 }
 
 /****************************************************************
@@ -78,13 +87,8 @@ int OneVoter::GetStationNumber() const {
 **/
 void OneVoter::AssignStation(int station_number,
                              int start_time_seconds) {
-  which_station_ = station_number;
-
+  which_station_ = static_cast<int16_t>(station_number);
   time_start_voting_seconds_ = start_time_seconds;
-  time_done_voting_seconds_ = time_start_voting_seconds_
-                            + time_vote_duration_seconds_;
-  time_waiting_seconds_ = time_start_voting_seconds_
-                        - time_arrival_seconds_;
 }
 
 /****************************************************************
@@ -171,7 +175,7 @@ string OneVoter::ConvertTime(int time_in_seconds) const {
  * Function ToString
  * Create a string representation of this voter.
 **/
-string OneVoter::ToString() {
+string OneVoter::ToString() const {
   string s = kTag;
 
   s += Utils::Format(sequence_, 7);
@@ -9,6 +9,15 @@
  * are created until the simulation stops it and each voter is
  * a part of a voter precinct (onepct.cc). 
  *
+ * A voter is packed into sixteen bytes with no vtable, so each
+ * map node the simulation walks every second is that much smaller
+ * and copying a voter is a plain copy. Only the arrival,
+ * the start of voting, the duration and the station are kept;
+ * the wait and the time done voting are worked out from them.
+ * The duration is sixteen bits and the station fifteen, and the
+ * configuration and the station counts are checked against
+ * kMaxDurationSeconds and kMaxStationCount when they are read.
+ *
  * Author/copyright:  Duncan Buell
  * Modified by: Group 6
  * Date: 1 December 2016
@@ -18,14 +27,27 @@
 #ifndef ONEVOTER_H
 #define ONEVOTER_H
 
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <type_traits>
+
 #include "../Utilities/utils.h"
 
 using namespace std;
 
+#include "arena.h"
+
 static int kDummyVoterInt = -333;
 
 class OneVoter {
 public:
+/****************************************************************
+ * The largest duration and station count a voter can hold.
+**/
+ static constexpr int kMaxDurationSeconds = UINT16_MAX;
+ static constexpr int kMaxStationCount = INT16_MAX;
+
 /****************************************************************
  * Constructors and destructors for the class. 
 **/
@@ -33,39 +55,36 @@ public:
  OneVoter(int sequence, int arrival_seconds, int duration_seconds);
  //each voter has a unique sequence, arrival time (in seconds), 
  //and time spent voting (duration) 
- 
- virtual ~OneVoter() = default;
+
+ ~OneVoter() = default;
 
 /****************************************************************
  * Accessors for voter details 
 **/
+ int GetSequence() const;
  int GetStationNumber() const;
  int GetTimeArrival() const;
  int GetTimeDoneVoting() const;
  int GetTimeWaiting() const;
 
 /****************************************************************
- * General functions to assign the voter to a station and check
- * if the voter has finished voting. Also has a ToString() and 
+ * General functions to assign the voter to a station. Also has a ToString() and 
  * GetTimeInQ() that returns the amount of time the voter spent
  * waiting in line. The ToStringHeader() formats the output
  * without starting a new line for use in a table. 
 **/
  void AssignStation(int station_number, int start_time_seconds);
- void DoneVoting();
  int GetTimeInQ() const;
 
- string ToString();
+ string ToString() const;
  static string ToStringHeader();
 
 private:
- int sequence_ = kDummyVoterInt;
- int time_arrival_seconds_ = kDummyVoterInt;
- int time_done_voting_seconds_ = kDummyVoterInt;
- int time_start_voting_seconds_ = kDummyVoterInt;
- int time_vote_duration_seconds_ = kDummyVoterInt;
- int time_waiting_seconds_ = kDummyVoterInt;
- int which_station_ = kDummyVoterInt;
+ int32_t sequence_ = kDummyVoterInt;
+ int32_t time_arrival_seconds_ = kDummyVoterInt;
+ int32_t time_start_voting_seconds_ = kDummyVoterInt;
+ uint16_t time_vote_duration_seconds_ = 0;
+ int16_t which_station_ = kDummyVoterInt;
  //sets member variable values
 
 /****************************************************************
@@ -77,4 +96,15 @@ private:
  string GetTOD(int time) const;
 };
 
+static_assert(sizeof(OneVoter) == 16, "OneVoter should pack into 16 bytes");
+static_assert(is_trivially_copyable<OneVoter>::value,
+              "OneVoter should copy as plain bytes");
+
+/****************************************************************
+ * The voters of a precinct keyed by a time in seconds. The maps
+ * draw from the thread's arena while a precinct is simulated.
+**/
+typedef multimap<int, OneVoter, less<int>,
+                 ArenaAllocator<pair<const int, OneVoter> > > VoterMap;
+
 #endif // ONEVOTER_H
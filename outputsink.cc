@@ -0,0 +1,150 @@
+#include "outputsink.h"
+/****************************************************************
+ * Implementation for the 'OutputSink' classes.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+/****************************************************************
+ * Function Output
+ * Sends the string, at 'level', to this sink's Write().
+**/
+void OutputSink::Output(const string& outstring, int level) {
+  this->Write(outstring, level);
+}
+
+/****************************************************************
+ * Constructor.
+**/
+TeeSink::TeeSink(ofstream& out_stream, ofstream& log_stream, int out_level,
+                 int log_level)
+  : log_level_(log_level), log_stream_(log_stream), out_level_(out_level),
+    out_stream_(out_stream) {
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetBytesFormatted
+ * Returns the bytes of every string given to the sink.
+**/
+long long TeeSink::GetBytesFormatted() const {
+  return bytes_formatted_;
+}
+
+/****************************************************************
+ * Function GetBytesLog
+ * Returns the bytes written to the log file.
+**/
+long long TeeSink::GetBytesLog() const {
+  return bytes_log_;
+}
+
+/****************************************************************
+ * Function GetBytesOut
+ * Returns the bytes written to the out file.
+**/
+long long TeeSink::GetBytesOut() const {
+  return bytes_out_;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function ToString
+ * Returns the bytes formatted and written, and each file's level.
+**/
+string TeeSink::ToString() const {
+  return "bytes formatted " + Utils::Format((double)bytes_formatted_, 12, 0)
+       + " out " + Utils::Format((double)bytes_out_, 12, 0)
+       + " (level " + Utils::Format(out_level_, 1) + ")"
+       + " log " + Utils::Format((double)bytes_log_, 12, 0)
+       + " (level " + Utils::Format(log_level_, 1) + ")";
+}
+
+/****************************************************************
+ * Function Write
+ * Writes the string to each file whose level takes it, from the
+ * one string, flushing each as Utils::Output does.
+**/
+void TeeSink::Write(const string& outstring, int level) {
+  bytes_formatted_ += outstring.size();
+  if (level <= out_level_) {
+    out_stream_.write(outstring.data(), outstring.size());
+    out_stream_.flush();
+    bytes_out_ += outstring.size();
+  }
+  if (level <= log_level_) {
+    log_stream_.write(outstring.data(), outstring.size());
+    log_stream_.flush();
+    bytes_log_ += outstring.size();
+  }
+}
+
+/****************************************************************
+ * Function GetLines
+ * Returns the buffered strings with their levels.
+**/
+const vector<pair<int, string> >& BufferSink::GetLines() const {
+  return lines_;
+}
+
+/****************************************************************
+ * Function Write
+ * Keeps the string and its level until FlushTo() is called.
+**/
+void BufferSink::Write(const string& outstring, int level) {
+  lines_.push_back(make_pair(level, outstring));
+}
+
+/****************************************************************
+ * Function FlushTo
+ * Sends the buffered strings on to 'sink' one at a time, so the
+ * bytes written are exactly those an unbuffered run would write.
+**/
+void BufferSink::FlushTo(OutputSink& sink) {
+  for (auto iter = lines_.begin(); iter != lines_.end(); ++iter) {
+    sink.Output(iter->second, iter->first);
+  }
+  lines_.clear();
+}
+
+/****************************************************************
+ * Function ToString
+ * Returns the buffered strings run together.
+**/
+string BufferSink::ToString() const {
+  string s = "";
+  for (auto iter = lines_.begin(); iter != lines_.end(); ++iter) {
+    s += iter->second;
+  }
+  return s;
+}
+
+/****************************************************************
+ * Constructor.
+**/
+TaggedSink::TaggedSink(OutputSink& sink, const string& tag)
+  : sink_(sink), tag_(tag) {
+}
+
+/****************************************************************
+ * Function Write
+ * Passes the string on, at its level, with the tag in front of
+ * each line. A string need not end its line, so whether the next
+ * one starts a line is remembered.
+**/
+void TaggedSink::Write(const string& outstring, int level) {
+  string tagged = "";
+  for (auto iter = outstring.begin(); iter != outstring.end(); ++iter) {
+    if (at_line_start_ && ('\n' != *iter))
+      tagged += tag_;
+    tagged += *iter;
+    at_line_start_ = ('\n' == *iter);
+  }
+  sink_.Output(tagged, level);
+}
@@ -0,0 +1,144 @@
+/****************************************************************
+ * Header for the 'OutputSink' classes.
+ *
+ * An OutputSink is where a precinct sends its report lines, each
+ * string at a level of detail: kSummary for the lines that say
+ * what was run and what came of it, kDetail for the per-iteration
+ * statistics, histograms and the like that a plain run has always
+ * written, and kVoters for every voter of every iteration. The
+ * TeeSink writes each string once to the out file and once to
+ * the log file, to each only if it is at or below that file's
+ * level, and counts the bytes. The BufferSink keeps the strings
+ * and their levels in order so that a precinct simulated on a
+ * worker thread can have its report written later, in input
+ * order, without its lines being mixed with anyone else's. The
+ * TaggedSink puts a tag in front of every line it passes on, so
+ * that runs of several configurations can share one out file.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+class OutputSink {
+public:
+ static const int kSummary = 0;
+ static const int kDetail = 1;
+ static const int kVoters = 2;
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ OutputSink() = default;
+ virtual ~OutputSink() = default;
+
+/****************************************************************
+ * General functions. Output() sends a string at a level, by
+ * default kSummary; each kind of sink says in Write() what it
+ * does with it.
+**/
+ void Output(const string& outstring, int level = kSummary);
+
+protected:
+ virtual void Write(const string& outstring, int level) = 0;
+};
+
+class TeeSink : public OutputSink {
+public:
+/****************************************************************
+ * Constructors and destructors for the class. The sink writes
+ * to 'out_stream' what is at 'out_level' or below and to
+ * 'log_stream' what is at 'log_level' or below.
+**/
+ TeeSink(ofstream& out_stream, ofstream& log_stream, int out_level,
+         int log_level);
+ virtual ~TeeSink() = default;
+
+/****************************************************************
+ * Accessors.
+**/
+ long long GetBytesFormatted() const;
+ long long GetBytesLog() const;
+ long long GetBytesOut() const;
+
+/****************************************************************
+ * General functions. ToString() returns the bytes formatted and
+ * written to each file.
+**/
+ string ToString() const;
+
+protected:
+ void Write(const string& outstring, int level) override;
+
+private:
+ long long bytes_formatted_ = 0;
+ long long bytes_log_ = 0;
+ long long bytes_out_ = 0;
+ int log_level_ = kDetail;
+ ofstream& log_stream_;
+ int out_level_ = kDetail;
+ ofstream& out_stream_;
+};
+
+class BufferSink : public OutputSink {
+public:
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ BufferSink() = default;
+ virtual ~BufferSink() = default;
+
+/****************************************************************
+ * Accessors. GetLines() returns the buffered lines, each with
+ * its level, in the order received.
+**/
+ const vector<pair<int, string> >& GetLines() const;
+
+/****************************************************************
+ * General functions. FlushTo() sends every buffered line to
+ * another sink, at its level, in the order received, and empties
+ * the buffer; ToString() returns them, whatever their level,
+ * without emptying it.
+**/
+ void FlushTo(OutputSink& sink);
+ string ToString() const;
+
+protected:
+ void Write(const string& outstring, int level) override;
+
+private:
+ vector<pair<int, string> > lines_;
+};
+
+class TaggedSink : public OutputSink {
+public:
+/****************************************************************
+ * Constructors and destructors for the class. The sink passes
+ * what it is given to 'sink' with 'tag' at the start of every
+ * line that is not empty.
+**/
+ TaggedSink(OutputSink& sink, const string& tag);
+ virtual ~TaggedSink() = default;
+
+protected:
+ void Write(const string& outstring, int level) override;
+
+private:
+ bool at_line_start_ = true;
+ OutputSink& sink_;
+ string tag_;
+};
+
+#endif // OUTPUTSINK_H
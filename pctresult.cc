@@ -0,0 +1,158 @@
+#include "pctresult.h"
+/****************************************************************
+ * Implementation for the 'PctResult' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * The record is a run of whitespace-separated fields:
+ *   R2 stationcount
+ *   then per station count:
+ *     stations iterationcount (-1 if screened)
+ *       iteration mean dev toolong toolong+10 toolong+20
+ *         servicedemand arrivalsum                       (each)
+ *     histocount (-1 if none) then minute count pairs
+ * Doubles are written with 17 significant digits, which reads
+ * back to the same bits, so a report written from a record that
+ * was read back is the same as the first one.
+ *
+**/
+
+#include <iomanip>
+#include <sstream>
+
+static const string kRecordTag = "R2";
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function ReadRecord
+ * Fills this result from a record line. On a malformed record
+ * the result is left empty and false is returned.
+**/
+bool PctResult::ReadRecord(const string& record) {
+  istringstream instream(record);
+  string tag;
+  int station_count_count = 0;
+
+  stations_.clear();
+  instream >> tag >> station_count_count;
+  if (!instream || (kRecordTag != tag) || (station_count_count < 0))
+    return false;
+
+  for (int sub = 0; sub < station_count_count; ++sub) {
+    StationStats station;
+    int iteration_count = 0;
+    instream >> station.station_count >> iteration_count;
+    station.screened = (-1 == iteration_count);
+    if (station.screened)
+      iteration_count = 0;
+    if (!instream || (iteration_count < 0)) {
+      stations_.clear();
+      return false;
+    }
+    for (int iter = 0; iter < iteration_count; ++iter) {
+      IterationStats stats;
+      instream >> stats.iteration >> stats.wait_mean_seconds
+               >> stats.wait_dev_seconds >> stats.toolong_count
+               >> stats.toolong_count_plus10 >> stats.toolong_count_plus20
+               >> stats.service_demand_seconds >> stats.arrival_sum_seconds;
+      station.iterations.push_back(stats);
+    }
+
+    int histo_count = 0;
+    instream >> histo_count;
+    station.has_histo = (histo_count >= 0);
+    for (int histo = 0; histo < histo_count; ++histo) {
+      int minutes = 0;
+      int count = 0;
+      instream >> minutes >> count;
+      station.histo[minutes] = count;
+    }
+    if (!instream) {
+      stations_.clear();
+      return false;
+    }
+    stations_.push_back(station);
+  }
+  return true;
+}
+
+/****************************************************************
+ * Function Rescore
+ * Returns the result as it would have been had the 'too long'
+ * wait been 'toolong_minutes': the toolong counts are worked out
+ * again from each iteration's histogram of waits, and the result
+ * ends at the first station count at which no iteration has a
+ * voter who waited too long, as OnePct::ComputeResult would have
+ * stopped there. This result must have been simulated at least
+ * that far, which it has if its own 'too long' was no longer.
+**/
+PctResult PctResult::Rescore(int toolong_minutes) const {
+  PctResult rescored;
+  for (auto iter = stations_.begin(); iter != stations_.end(); ++iter) {
+    StationStats station = *iter;
+    bool good_enough = !station.screened;
+    for (auto stats = station.iterations.begin();
+              stats != station.iterations.end(); ++stats) {
+      stats->toolong_count = 0;
+      stats->toolong_count_plus10 = 0;
+      stats->toolong_count_plus20 = 0;
+      for (auto minutes = stats->wait_minutes.begin();
+                minutes != stats->wait_minutes.end(); ++minutes) {
+        if (minutes->first > toolong_minutes)
+          stats->toolong_count += minutes->second;
+        if (minutes->first > toolong_minutes + 10)
+          stats->toolong_count_plus10 += minutes->second;
+        if (minutes->first > toolong_minutes + 20)
+          stats->toolong_count_plus20 += minutes->second;
+      }
+      if (stats->toolong_count > 0)
+        good_enough = false;
+    }
+    rescored.stations_.push_back(station);
+    if (good_enough)
+      break;
+  }
+  return rescored;
+}
+
+/****************************************************************
+ * Function ToStringRecord
+ * Returns the result as a record line.
+**/
+string PctResult::ToStringRecord() const {
+  ostringstream outstream;
+  outstream << setprecision(17);
+
+  outstream << kRecordTag << " " << stations_.size();
+  for (auto iter = stations_.begin(); iter != stations_.end(); ++iter) {
+    outstream << "  " << iter->station_count << " ";
+    if (iter->screened)
+      outstream << -1;
+    else
+      outstream << iter->iterations.size();
+    for (auto stats = iter->iterations.begin();
+              stats != iter->iterations.end(); ++stats) {
+      outstream << " " << stats->iteration << " " << stats->wait_mean_seconds
+                << " " << stats->wait_dev_seconds << " " << stats->toolong_count
+                << " " << stats->toolong_count_plus10
+                << " " << stats->toolong_count_plus20
+                << " " << stats->service_demand_seconds
+                << " " << stats->arrival_sum_seconds;
+    }
+
+    if (iter->has_histo) {
+      outstream << " " << iter->histo.size();
+      for (auto histo = iter->histo.begin(); histo != iter->histo.end();
+                ++histo) {
+        outstream << " " << histo->first << " " << histo->second;
+      }
+    }
+    else {
+      outstream << " -1";
+    }
+  }
+  return outstream.str();
+}
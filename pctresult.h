@@ -0,0 +1,102 @@
+/****************************************************************
+ * Header for the 'PctResult' class.
+ *
+ * A PctResult holds everything one precinct's simulation works
+ * out: for each station count tried, the statistics of every
+ * iteration (what DoStatistics reports) and, for the station
+ * counts the precinct asked to have histogrammed, the wait-time
+ * histogram. It holds numbers only, not the precinct's labels,
+ * so the report lines can be written from it for any precinct
+ * whose simulation inputs are the same.
+ *
+ * A result can be written as one line of text and read back
+ * exactly, which is how results are kept on disk.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef PCTRESULT_H
+#define PCTRESULT_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "queueseries.h"
+
+class PctResult {
+public:
+/****************************************************************
+ * The statistics of one iteration at one station count, with
+ * the realised total service demand and sum of arrival times of
+ * its voters, which serve as control variates. 'wait_minutes' is
+ * the iteration's histogram of waits in minutes; it is kept only
+ * for a toolong sweep and is not part of the record.
+**/
+ struct IterationStats {
+   int iteration = 0;
+   double wait_mean_seconds = 0.0;
+   double wait_dev_seconds = 0.0;
+   int toolong_count = 0;
+   int toolong_count_plus10 = 0;
+   int toolong_count_plus20 = 0;
+   double service_demand_seconds = 0.0;
+   double arrival_sum_seconds = 0.0;
+   map<int, int> wait_minutes;
+ };
+
+/****************************************************************
+ * All the iterations at one station count, and the histogram of
+ * waits in minutes summed over them if it was asked for. The
+ * queue series and the voter trace blocks are kept only when a
+ * series or trace file is asked for, and the voters as text only
+ * when a file's level is kVoters; like wait_minutes, the arena
+ * figures and the wall time the count took, they are not part of
+ * the record. A count the
+ * prescreen showed to be too few is 'screened' and has no
+ * iterations.
+**/
+ struct StationStats {
+   int station_count = 0;
+   bool screened = false;
+   vector<IterationStats> iterations;
+   bool has_histo = false;
+   map<int, int> histo;
+   QueueSeries series;
+   string trace;
+   string voters;
+   long long arena_bytes_allocated = 0;
+   long long arena_high_water_bytes = 0;
+   double wall_seconds = 0.0;
+ };
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ PctResult() = default;
+ virtual ~PctResult() = default;
+
+/****************************************************************
+ * Public variables, one entry per station count in the order
+ * they were simulated.
+**/
+ vector<StationStats> stations_;
+
+/****************************************************************
+ * General functions. ToStringRecord() writes the result as a
+ * single line with no newline; ReadRecord() reads such a line
+ * and returns false if it is not a well-formed record.
+ * Rescore() needs the iterations' wait_minutes histograms.
+**/
+ bool ReadRecord(const string& record);
+ PctResult Rescore(int toolong_minutes) const;
+ string ToStringRecord() const;
+};
+
+#endif // PCTRESULT_H
@@ -0,0 +1,396 @@
+#include "queryserver.h"
+/****************************************************************
+ * Implementation for the 'QueryServer' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * The latency of a query runs from when its line was read to
+ * when its answer was ready, and is reported in two parts: the
+ * time it waited for a worker and the time it ran.
+ *
+**/
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#include "resultcache.h"
+
+static const string kTag = "SERVER: ";
+
+/****************************************************************
+ * Function: ParseNumber
+ * Sets 'number' from 'text' and returns true if all of 'text'
+ * is a number.
+**/
+static bool ParseNumber(const string& text, double& number) {
+  char* parsed_to = nullptr;
+  number = strtod(text.c_str(), &parsed_to);
+  return !text.empty() && ('\0' == *parsed_to);
+}
+
+/****************************************************************
+ * Function: ParseWhole
+ * Sets 'number' from 'text' and returns true if all of 'text'
+ * is a whole number from 'least' to 'most'.
+**/
+static bool ParseWhole(const string& text, long long least, long long most,
+                       long long& number) {
+  char* parsed_to = nullptr;
+  errno = 0;
+  number = strtoll(text.c_str(), &parsed_to, 10);
+  return !text.empty() && ('\0' == *parsed_to) && (0 == errno) &&
+         (number >= least) && (number <= most);
+}
+
+/****************************************************************
+ * Function: WriteAll
+ * Writes all of 'text' to a socket, however many writes it takes.
+**/
+static void WriteAll(int fd, const string& text) {
+  size_t written = 0;
+  while (written < text.size()) {
+    ssize_t count = write(fd, text.data() + written, text.size() - written);
+    if (count < 0) {
+      if (EINTR == errno)
+        continue;
+      return;
+    }
+    written += static_cast<size_t>(count);
+  }
+}
+
+/****************************************************************
+ * Constructor.
+**/
+QueryServer::QueryServer(const Configuration& config,
+                         const map<int, OnePct>& pcts)
+  : config_(config), pcts_(pcts) {
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Answer
+ * Parses and answers one query. The answer starts 'OK' or 'ERR'.
+**/
+string QueryServer::Answer(const string& query) const {
+  istringstream instream(query);
+  map<string, double> fields;
+  string name = "";
+  string value = "";
+  while (instream >> name) {
+    if (!(instream >> value))
+      return "ERR '" + name + "' needs a value";
+    if (("pct" != name) && ("stations" != name) && ("turnout" != name) &&
+        ("voters" != name) && ("iterations" != name))
+      return "ERR unknown field '" + name + "'";
+    if ("turnout" == name) {
+      double number = 0.0;
+      if (!ParseNumber(value, number) || (number <= 0.0) || (number > 100.0))
+        return "ERR 'turnout' needs a percent above 0 and at most 100, not '"
+               + value + "'";
+      fields[name] = number;
+      continue;
+    }
+    long long least = ("pct" == name) ? 0 : 1;
+    long long most = INT_MAX;
+    if ("stations" == name)
+      most = OneVoter::kMaxStationCount;
+    else if ("voters" == name)
+      most = kMaxVoters;
+    else if ("iterations" == name)
+      most = kMaxIterations;
+    long long number = 0;
+    if (!ParseWhole(value, least, most, number))
+      return "ERR '" + name + "' needs a whole number from "
+             + to_string(least) + " to "
+             + to_string(most) + ", not '" + value + "'";
+    fields[name] = static_cast<double>(number);
+  }
+  if (0 == fields.count("pct"))
+    return "ERR a query needs 'pct N'";
+
+  int pct_number = static_cast<int>(fields["pct"]);
+  auto found = pcts_.find(pct_number);
+  if (pcts_.end() == found)
+    return "ERR no precinct " + to_string(pct_number);
+
+  OnePct pct = found->second;
+  if (fields.count("voters") > 0) {
+    pct.SetExpectedVoters(static_cast<int>(fields["voters"]));
+  }
+  else if (fields.count("turnout") > 0) {
+    pct.SetExpectedVoters(static_cast<int>(round(fields["turnout"] / 100.0
+                                           * pct.GetRegisteredVoters())));
+  }
+  if (pct.GetExpectedVoters() <= 0)
+    return "ERR precinct " + to_string(pct_number) + " would have no voters";
+  if (pct.GetExpectedVoters() > kMaxVoters)
+    return "ERR precinct " + to_string(pct_number) + " would have more than "
+           + to_string(kMaxVoters) + " voters";
+
+  Configuration config = config_;
+  if (fields.count("iterations") > 0)
+    config.number_of_iterations_ = static_cast<int>(fields["iterations"]);
+  int stations_count = 0;
+  if (fields.count("stations") > 0)
+    stations_count = static_cast<int>(fields["stations"]);
+
+  string canonical = "query pct " + to_string(pct_number)
+                   + " voters " + to_string(pct.GetExpectedVoters())
+                   + " stations " + to_string(stations_count)
+                   + " iterations " + to_string(config.number_of_iterations_);
+  MyRandom random(config.seed_, ResultCache::Hash(canonical));
+
+  PctResult::StationStats station;
+  if (stations_count > 0) {
+    station = pct.SimulateStationCount(config, random, stations_count);
+  }
+  else {
+    station = pct.ComputeResult(config, random).stations_.back();
+  }
+
+  double wait_mean = 0.0;
+  double wait_dev = 0.0;
+  double toolong[3] = { 0.0, 0.0, 0.0 };
+  for (auto stats = station.iterations.begin();
+            stats != station.iterations.end(); ++stats) {
+    wait_mean += stats->wait_mean_seconds;
+    wait_dev += stats->wait_dev_seconds;
+    toolong[0] += stats->toolong_count;
+    toolong[1] += stats->toolong_count_plus10;
+    toolong[2] += stats->toolong_count_plus20;
+  }
+  double iterations = static_cast<double>(station.iterations.size());
+  double voters = static_cast<double>(pct.GetExpectedVoters());
+
+  string s = "OK pct " + to_string(pct_number)
+           + " voters " + to_string(pct.GetExpectedVoters())
+           + " stations " + to_string(station.station_count)
+           + " iterations " + to_string(config.number_of_iterations_)
+           + " mean/dev wait (mins) "
+           + Utils::Format(wait_mean/iterations/60.0, 8, 2) + " "
+           + Utils::Format(wait_dev/iterations/60.0, 8, 2) + " toolong";
+  for (int sub = 0; sub < 3; ++sub) {
+    s += " " + Utils::Format(toolong[sub]/iterations, 8, 1) + " "
+       + Utils::Format(100.0*toolong[sub]/iterations/voters, 6, 2);
+  }
+  return s;
+}
+
+/****************************************************************
+ * Function ServeSocket
+ * Listens on a Unix domain socket at 'path', replacing anything
+ * there, and serves each client on a thread of its own, all of
+ * them sharing one pool of workers. After a client says
+ * 'shutdown' no new client is taken, the clients already
+ * connected are served until they hang up, and the socket is
+ * removed.
+**/
+void QueryServer::ServeSocket(const string& path) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    cout << kTag << "ERROR socket path '" << path << "' is too long" << endl;
+    exit(1);
+  }
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(path.c_str());
+  if ((listen_fd < 0) ||
+      (bind(listen_fd, reinterpret_cast<sockaddr*>(&address),
+            sizeof(address)) < 0) ||
+      (listen(listen_fd, 16) < 0)) {
+    cout << kTag << "ERROR cannot listen on '" << path << "': "
+         << strerror(errno) << endl;
+    exit(1);
+  }
+  cout << kTag << "listening on '" << path << "'" << endl;
+
+  ThreadPool pool(config_.thread_count_);
+  atomic<bool> shutdown_asked(false);
+  vector<thread> clients;
+  while (!shutdown_asked) {
+    int connection_fd = accept(listen_fd, nullptr, nullptr);
+    if (connection_fd < 0) {
+      if (shutdown_asked || (EINTR != errno))
+        break;
+      continue;
+    }
+    clients.push_back(thread(&QueryServer::ServeConnection, this,
+                             connection_fd, listen_fd, ref(pool),
+                             ref(shutdown_asked)));
+  }
+  for (auto iter = clients.begin(); iter != clients.end(); ++iter) {
+    iter->join();
+  }
+  close(listen_fd);
+  unlink(path.c_str());
+}
+
+/****************************************************************
+ * Function ServeStream
+ * Answers the queries read from 'in' on 'out', each line as
+ * soon as it is ready, and returns once every query read before
+ * the end of 'in' or a 'quit' has been answered.
+**/
+void QueryServer::ServeStream(istream& in, ostream& out) {
+  mutex out_mutex;
+  vector<future<void> > answered;
+  {
+    ThreadPool pool(config_.thread_count_);
+    string line = "";
+    int id = 0;
+    while (getline(in, line)) {
+      if (line.find_first_not_of(" \t\r") == string::npos)
+        continue;
+      if (("quit" == line) || ("shutdown" == line))
+        break;
+      ++id;
+      answered.push_back(this->Submit(pool, id, line,
+                                      [&out, &out_mutex](const string& reply) {
+        lock_guard<mutex> lock(out_mutex);
+        out << reply << endl;
+      }));
+    }
+  }
+  for (auto iter = answered.begin(); iter != answered.end(); ++iter) {
+    iter->get();
+  }
+}
+
+/****************************************************************
+ * Function ToStringSummary
+ * Returns the number of queries answered and their latencies.
+**/
+string QueryServer::ToStringSummary() const {
+  vector<double> latencies;
+  {
+    lock_guard<mutex> lock(mutex_);
+    latencies = latencies_ms_;
+  }
+  string s = "queries " + Utils::Format((int)latencies.size(), 6);
+  if (latencies.empty())
+    return s;
+
+  sort(latencies.begin(), latencies.end());
+  double sum = 0.0;
+  for (auto iter = latencies.begin(); iter != latencies.end(); ++iter) {
+    sum += *iter;
+  }
+  int last = static_cast<int>(latencies.size()) - 1;
+  s += " latency (ms) mean " + Utils::Format(sum / latencies.size(), 10, 2)
+     + " p50 " + Utils::Format(latencies.at(last / 2), 10, 2)
+     + " p95 " + Utils::Format(latencies.at((95 * last + 50) / 100), 10, 2)
+     + " max " + Utils::Format(latencies.at(last), 10, 2);
+  return s;
+}
+
+/****************************************************************
+ * Private functions.
+**/
+/****************************************************************
+ * Function ServeConnection
+ * Answers the queries of one socket client until it says 'quit'
+ * or 'shutdown' or hangs up, then waits for its answers to be
+ * written and closes the connection. 'shutdown' also shuts the
+ * listening socket, which stops ServeSocket() accepting.
+**/
+void QueryServer::ServeConnection(int connection_fd, int listen_fd,
+                                  ThreadPool& pool,
+                                  atomic<bool>& shutdown_asked) {
+  mutex write_mutex;
+  vector<future<void> > answered;
+  string pending = "";
+  char buffer[4096];
+  int id = 0;
+  bool done = false;
+
+  while (!done) {
+    ssize_t count = read(connection_fd, buffer, sizeof(buffer));
+    if (count < 0) {
+      if (EINTR == errno)
+        continue;
+      break;
+    }
+    if (0 == count)
+      break;
+    pending.append(buffer, static_cast<size_t>(count));
+
+    size_t newline = pending.find('\n');
+    while (!done && (string::npos != newline)) {
+      string line = pending.substr(0, newline);
+      pending.erase(0, newline + 1);
+      newline = pending.find('\n');
+      if (!line.empty() && ('\r' == line[line.size() - 1]))
+        line.erase(line.size() - 1);
+
+      if (line.find_first_not_of(" \t") == string::npos)
+        continue;
+      if ("quit" == line) {
+        done = true;
+      }
+      else if ("shutdown" == line) {
+        shutdown_asked = true;
+        shutdown(listen_fd, SHUT_RDWR);
+        done = true;
+      }
+      else {
+        ++id;
+        answered.push_back(this->Submit(pool, id, line,
+                          [connection_fd, &write_mutex](const string& reply) {
+          lock_guard<mutex> lock(write_mutex);
+          WriteAll(connection_fd, reply + "\n");
+        }));
+      }
+    }
+  }
+
+  for (auto iter = answered.begin(); iter != answered.end(); ++iter) {
+    iter->get();
+  }
+  close(connection_fd);
+}
+
+/****************************************************************
+ * Function Submit
+ * Queues a query on the pool. When it has been answered, the
+ * answer with its id and latency goes to 'reply' and the latency
+ * is kept for the summary.
+**/
+future<void> QueryServer::Submit(ThreadPool& pool, int id, const string& query,
+                                 function<void(const string&)> reply) {
+  auto received = chrono::steady_clock::now();
+  return pool.Submit([this, id, query, reply, received]() {
+    auto started = chrono::steady_clock::now();
+    string answer = this->Answer(query);
+    auto finished = chrono::steady_clock::now();
+    double queued_ms = chrono::duration<double, milli>(started - received).count();
+    double run_ms = chrono::duration<double, milli>(finished - started).count();
+    {
+      lock_guard<mutex> lock(mutex_);
+      latencies_ms_.push_back(queued_ms + run_ms);
+    }
+
+    size_t space = answer.find(' ');
+    reply(answer.substr(0, space) + " " + to_string(id) + answer.substr(space)
+          + " latency (ms) queued " + Utils::Format(queued_ms, 9, 2)
+          + " run " + Utils::Format(run_ms, 9, 2));
+  });
+}
@@ -0,0 +1,90 @@
+/****************************************************************
+ * Header for the 'QueryServer' class.
+ *
+ * A QueryServer keeps a configuration (with its service times)
+ * and a set of precincts in memory and answers what-if queries
+ * about them, one per line, for as long as it is asked. A query
+ * is a run of 'name value' pairs:
+ *   pct N [stations S] [turnout T | voters V] [iterations K]
+ * which simulates precinct N with its expected voters replaced
+ * by T percent of its registered voters, or by V, for K
+ * iterations. With 'stations' the answer is for S stations;
+ * without, it is for the station count RunSimulationPct would
+ * settle on. The answer is the mean over the iterations of what
+ * DoStatistics reports, with the request's latency:
+ *   OK id pct N voters V stations S iterations K wait (mins) ...
+ *   ERR id message
+ * N, S, V and K are whole numbers, S at most kMaxStationCount,
+ * V at most kMaxVoters and K at most kMaxIterations, so that no
+ * one query can hold a worker for long; T is a percent up to 100.
+ * 'quit' ends a connection and 'shutdown' stops a socket server.
+ *
+ * Queries run on a pool of worker threads, so a slow query does
+ * not hold up the ones behind it and answers can come back out
+ * of order; the id, the query's number on its connection, says
+ * which is which. A query draws from its own RN stream, named by
+ * the query, so the same query always gets the same answer.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "configuration.h"
+#include "onepct.h"
+#include "threadpool.h"
+
+class QueryServer {
+public:
+ static const int kMaxIterations = 1000;
+ static const int kMaxVoters = 100000;
+
+/****************************************************************
+ * Constructors and destructors for the class. The server only
+ * refers to the configuration and precincts, which must outlive it.
+**/
+ QueryServer(const Configuration& config, const map<int, OnePct>& pcts);
+ virtual ~QueryServer() = default;
+
+/****************************************************************
+ * General functions. Answer() works out one query's answer with
+ * no id or latency. ServeStream() answers the lines of 'in' on
+ * 'out' until 'in' ends or says 'quit'; ServeSocket() listens
+ * on a Unix domain socket until a client says 'shutdown'.
+**/
+ string Answer(const string& query) const;
+ void ServeSocket(const string& path);
+ void ServeStream(istream& in, ostream& out);
+ string ToStringSummary() const;
+
+private:
+ const Configuration& config_;
+ const map<int, OnePct>& pcts_;
+ mutable mutex mutex_;
+ vector<double> latencies_ms_;
+
+/****************************************************************
+ * Private functions.
+**/
+ void ServeConnection(int connection_fd, int listen_fd, ThreadPool& pool,
+                      atomic<bool>& shutdown_asked);
+ future<void> Submit(ThreadPool& pool, int id, const string& query,
+                     function<void(const string&)> reply);
+};
+
+#endif // QUERYSERVER_H
@@ -0,0 +1,206 @@
+#include "queueseries.h"
+/****************************************************************
+ * Implementation for the 'QueueSeries' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#include <algorithm>
+#include <cstdio>
+
+/****************************************************************
+ * Constructor.
+ * Sizes the arrays for twice the day.
+**/
+QueueSeries::QueueSeries(int day_minutes) {
+  int minutes = max(1, 2 * day_minutes);
+  queue_peak_.assign(minutes, 0);
+  busy_seconds_.assign(minutes, 0);
+  queue_seconds_.assign(minutes, 0);
+  station_seconds_.assign(minutes, 0);
+}
+
+/****************************************************************
+ * Function: AppendFixed
+ * Appends 'numerator' / 'denominator' with 'places' decimals, as
+ * "%.*f" prints the double nearest it. The rounding is done in
+ * integers, which is exact and much faster; a quotient exactly
+ * half way between two outputs is left to snprintf, since the
+ * double nearest it may lie on either side.
+**/
+static void AppendFixed(string& s, long long numerator, long long denominator,
+                        int places) {
+  long long scale = 1;
+  for (int place = 0; place < places; ++place) {
+    scale *= 10;
+  }
+  long long scaled = numerator * scale;
+  long long rounded = scaled / denominator;
+  long long twice_remainder = 2 * (scaled % denominator);
+  if (twice_remainder == denominator) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", places,
+             static_cast<double>(numerator) / denominator);
+    s += buffer;
+    return;
+  }
+  if (twice_remainder > denominator)
+    ++rounded;
+  s += to_string(rounded / scale) + ".";
+  string fraction = to_string(rounded % scale);
+  s.append(places - fraction.size(), '0');
+  s += fraction;
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetIterations
+ * Returns the number of iterations recorded or merged in.
+**/
+int QueueSeries::GetIterations() const {
+  return iterations_;
+}
+
+/****************************************************************
+ * Function GetMinutes
+ * Returns the number of minutes the arrays hold.
+**/
+int QueueSeries::GetMinutes() const {
+  return static_cast<int>(queue_seconds_.size());
+}
+
+/****************************************************************
+ * Function IsEmpty
+ * Returns true if nothing has been recorded.
+**/
+bool QueueSeries::IsEmpty() const {
+  return 0 == iterations_;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Merge
+ * Adds the series of another precinct, simulated for as many
+ * iterations, into this one, so the means become the sums over
+ * the precincts. The peaks are the larger of the two.
+**/
+void QueueSeries::Merge(const QueueSeries& other) {
+  if (other.GetMinutes() > this->GetMinutes()) {
+    queue_peak_.resize(other.GetMinutes(), 0);
+    busy_seconds_.resize(other.GetMinutes(), 0);
+    queue_seconds_.resize(other.GetMinutes(), 0);
+    station_seconds_.resize(other.GetMinutes(), 0);
+  }
+  for (int minute = 0; minute < other.GetMinutes(); ++minute) {
+    queue_peak_[minute] = max(queue_peak_[minute], other.queue_peak_[minute]);
+    busy_seconds_[minute] += other.busy_seconds_[minute];
+    queue_seconds_[minute] += other.queue_seconds_[minute];
+    station_seconds_[minute] += other.station_seconds_[minute];
+  }
+  iterations_ = max(iterations_, other.iterations_);
+}
+
+/****************************************************************
+ * Function RecordSpan
+ * Adds the seconds from 'first_second' up to but not including
+ * 'end_second', in each of which the same voters were waiting and
+ * being served, a minute's worth at a time.
+**/
+void QueueSeries::RecordSpan(int first_second, int end_second,
+                             int queue_length, int in_service, int stations) {
+  int last_minute = static_cast<int>(queue_seconds_.size()) - 1;
+  int second = first_second;
+  while (second < end_second) {
+    int minute = second / 60;
+    int seconds = min(end_second, (minute + 1) * 60) - second;
+    if (minute >= last_minute) {
+      minute = last_minute;
+      seconds = end_second - second;
+    }
+    if (queue_length > queue_peak_[minute])
+      queue_peak_[minute] = queue_length;
+    busy_seconds_[minute] += static_cast<long long>(in_service) * seconds;
+    queue_seconds_[minute] += static_cast<long long>(queue_length) * seconds;
+    station_seconds_[minute] += static_cast<long long>(stations) * seconds;
+    second += seconds;
+  }
+}
+
+/****************************************************************
+ * Function StartIteration
+ * Counts one more iteration into the averages.
+**/
+void QueueSeries::StartIteration() {
+  ++iterations_;
+}
+
+/****************************************************************
+ * Function ToStringCsvHeader
+ * Returns the CSV header line, after the names of the columns
+ * that the callers' prefixes fill in.
+**/
+string QueueSeries::ToStringCsvHeader(const string& prefix_names) {
+  return prefix_names + "minute,queue_mean,queue_peak,in_service_mean,"
+         "utilisation\n";
+}
+
+/****************************************************************
+ * Function ToStringCsv
+ * Returns one CSV row per minute in which stations were open.
+**/
+string QueueSeries::ToStringCsv(const string& prefix) const {
+  string s = "";
+  long long per_minute = 60LL * max(1, iterations_);
+  for (int minute = 0; minute < this->GetMinutes(); ++minute) {
+    if (0 == station_seconds_[minute])
+      continue;
+    s += prefix + to_string(minute) + ",";
+    AppendFixed(s, queue_seconds_[minute], per_minute, 3);
+    s += "," + to_string(queue_peak_[minute]) + ",";
+    AppendFixed(s, busy_seconds_[minute], per_minute, 3);
+    s += ",";
+    AppendFixed(s, busy_seconds_[minute], station_seconds_[minute], 4);
+    s += "\n";
+  }
+  return s;
+}
+
+/****************************************************************
+ * Function ToStringHourly
+ * Returns one line per hour in which stations were open, with
+ * the mean and peak queue, the mean number in service and the
+ * percentage of station time spent serving.
+**/
+string QueueSeries::ToStringHourly(const string& tag) const {
+  string s = "";
+  double per_hour = 3600.0 * max(1, iterations_);
+  for (int hour = 0; 60 * hour < this->GetMinutes(); ++hour) {
+    long long busy = 0;
+    long long queue = 0;
+    long long stations = 0;
+    int peak = 0;
+    for (int minute = 60 * hour;
+             minute < min(60 * (hour + 1), this->GetMinutes()); ++minute) {
+      busy += busy_seconds_[minute];
+      queue += queue_seconds_[minute];
+      stations += station_seconds_[minute];
+      peak = max(peak, queue_peak_[minute]);
+    }
+    if (0 == stations)
+      continue;
+    s += tag + "hour " + Utils::Format(hour, 3)
+       + " queue mean " + Utils::Format(queue / per_hour, 8, 2)
+       + " peak " + Utils::Format(peak, 6)
+       + " in service " + Utils::Format(busy / per_hour, 7, 2)
+       + " utilisation "
+       + Utils::Format(100.0 * busy / static_cast<double>(stations), 6, 2)
+       + "%\n";
+  }
+  return s;
+}
@@ -0,0 +1,76 @@
+/****************************************************************
+ * Header for the 'QueueSeries' class.
+ *
+ * A QueueSeries is a minute-by-minute record of a precinct's day
+ * summed over iterations: for each minute, the voter-seconds
+ * spent in the queue, the longest queue seen, the station-seconds
+ * spent serving voters, and the station-seconds open. Dividing
+ * by the iterations (and by 60 for a per-second average) gives
+ * the mean queue length, the mean number in service and the
+ * stations' utilisation in that minute.
+ *
+ * The arrays are sized once, for twice the length of the day, so
+ * recording a run of seconds is a few additions for each minute
+ * it touches; anything later than that goes in the last minute.
+ * Series of precincts add up, so one county series can be made by
+ * merging every precinct's; its peak is then the longest queue at
+ * any one precinct.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef QUEUESERIES_H
+#define QUEUESERIES_H
+
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+class QueueSeries {
+public:
+/****************************************************************
+ * Constructors and destructors for the class. A series made with
+ * no length is empty and records nothing.
+**/
+ QueueSeries() = default;
+ QueueSeries(int day_minutes);
+ virtual ~QueueSeries() = default;
+
+/****************************************************************
+ * Accessors.
+**/
+ int GetIterations() const;
+ int GetMinutes() const;
+ bool IsEmpty() const;
+
+/****************************************************************
+ * General functions. RecordSpan() is called for each run of
+ * seconds of an iteration in which the queue and the voters in
+ * service stay the same, and StartIteration() once before each.
+ * ToStringCsv() writes one row per minute in which stations were
+ * open, each starting with 'prefix'; ToStringHourly() writes one
+ * line per hour, each starting with 'tag'.
+**/
+ void Merge(const QueueSeries& other);
+ void RecordSpan(int first_second, int end_second, int queue_length,
+                 int in_service, int stations);
+ void StartIteration();
+
+ static string ToStringCsvHeader(const string& prefix_names);
+ string ToStringCsv(const string& prefix) const;
+ string ToStringHourly(const string& tag) const;
+
+private:
+ int iterations_ = 0;
+ vector<int> queue_peak_;
+ vector<long long> busy_seconds_;
+ vector<long long> queue_seconds_;
+ vector<long long> station_seconds_;
+};
+
+#endif // QUEUESERIES_H
@@ -0,0 +1,249 @@
+#include "responsesurface.h"
+/****************************************************************
+ * Implementation for the 'ResponseSurface' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * Grid point 'i' has voters_[i] expected voters. Its results are
+ * kept for the station counts first_simulated_[i] on up to the
+ * first count that was good enough (no voter in any iteration
+ * waited too long), which is first_good_enough_[i], or -1 if
+ * even the last count tried was not good enough. Below the first
+ * simulated count the point is taken as hopeless (everyone too
+ * long); above the good-enough count it is taken as fine.
+ *
+ * A query is good enough at 's' stations only if both grid
+ * points around it are, so the answer never asks for fewer
+ * stations than either neighbour needed.
+ *
+**/
+
+#include <algorithm>
+#include <future>
+
+#include "onepct.h"
+#include "resultcache.h"
+#include "threadpool.h"
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetGridPoints
+ * Returns the number of expected-voter values in the grid.
+**/
+int ResponseSurface::GetGridPoints() const {
+  return static_cast<int>(voters_.size());
+}
+
+/****************************************************************
+ * Function GetMaxStationCount
+ * Returns the most stations simulated at any grid point.
+**/
+int ResponseSurface::GetMaxStationCount() const {
+  return max_station_count_;
+}
+
+/****************************************************************
+ * Function GetWaitMean
+ * Returns the interpolated mean wait in seconds for the given
+ * voters at the given station count.
+**/
+double ResponseSurface::GetWaitMean(int expected_voters,
+                                    int stations_count) const {
+  int lower = 0;
+  double weight = 0.0;
+  bool outside = false;
+  this->FindBracket(expected_voters, lower, weight, outside);
+
+  double wait = this->WaitMeanAt(lower, stations_count);
+  if (weight > 0.0) {
+    wait = (1.0 - weight) * wait
+         + weight * this->WaitMeanAt(lower + 1, stations_count);
+  }
+  return wait;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Build
+ * Simulates 'grid_points' evenly spaced expected-voter counts
+ * from just above min_expected_to_simulate_ to
+ * max_expected_to_simulate_. Each grid point draws from its own
+ * RN stream, so the table is the same for any thread count.
+**/
+void ResponseSurface::Build(const Configuration& config, int grid_points,
+                            int thread_count) {
+  int lowest = max(1, config.min_expected_to_simulate_ + 1);
+  int highest = max(lowest, config.max_expected_to_simulate_);
+  if (grid_points < 2)
+    grid_points = 2;
+
+  voters_.clear();
+  for (int point = 0; point < grid_points; ++point) {
+    double fraction = static_cast<double>(point) / (grid_points - 1);
+    int voters = lowest + static_cast<int>(round(fraction * (highest - lowest)));
+    if (voters_.empty() || (voters > voters_.back()))
+      voters_.push_back(voters);
+  }
+
+  int point_count = static_cast<int>(voters_.size());
+  first_simulated_.assign(point_count, 0);
+  first_good_enough_.assign(point_count, -1);
+  toolong_fraction_.assign(point_count, vector<double>());
+  wait_mean_seconds_.assign(point_count, vector<double>());
+
+  ThreadPool pool(thread_count);
+  vector<future<void> > done;
+  for (int point = 0; point < point_count; ++point) {
+    done.push_back(pool.Submit([this, &config, point]() {
+      OnePct probe;
+      probe.SetExpectedVoters(voters_.at(point));
+      MyRandom random(config.seed_,
+                      ResultCache::Hash("surface " + to_string(voters_.at(point))));
+
+      first_simulated_.at(point) = probe.GetMinStationCount(config);
+      for (int stations_count = probe.GetMinStationCount(config);
+               stations_count <= probe.GetMaxStationCount(config);
+               ++stations_count) {
+        PctResult::StationStats station =
+            probe.SimulateStationCount(config, random, stations_count);
+
+        double wait_sum = 0.0;
+        int toolong_sum = 0;
+        for (auto stats = station.iterations.begin();
+                  stats != station.iterations.end(); ++stats) {
+          wait_sum += stats->wait_mean_seconds;
+          toolong_sum += stats->toolong_count;
+        }
+        double iterations = static_cast<double>(station.iterations.size());
+        wait_mean_seconds_.at(point).push_back(wait_sum / iterations);
+        toolong_fraction_.at(point).push_back(toolong_sum /
+                                     (iterations * voters_.at(point)));
+        if (0 == toolong_sum) {
+          first_good_enough_.at(point) = stations_count;
+          break;
+        }
+      }
+    }));
+  }
+  for (auto iter = done.begin(); iter != done.end(); ++iter) {
+    iter->get();
+  }
+
+  max_station_count_ = 0;
+  for (int point = 0; point < point_count; ++point) {
+    int last = first_simulated_.at(point)
+             + static_cast<int>(wait_mean_seconds_.at(point).size()) - 1;
+    max_station_count_ = max(max_station_count_, last);
+  }
+}
+
+/****************************************************************
+ * Function Query
+ * Returns the fewest stations at which the interpolated fraction
+ * of voters waiting too long is zero, with the interpolated mean
+ * wait and too-long fraction there.
+**/
+ResponseSurface::Answer ResponseSurface::Query(int expected_voters) const {
+  Answer answer;
+  int lower = 0;
+  double weight = 0.0;
+  bool outside = false;
+  this->FindBracket(expected_voters, lower, weight, outside);
+
+  answer.station_count = max_station_count_ + 1;
+  answer.extrapolated = true;
+  for (int stations_count = 1; stations_count <= max_station_count_;
+           ++stations_count) {
+    double toolong = this->ToolongAt(lower, stations_count);
+    if (weight > 0.0) {
+      toolong = (1.0 - weight) * toolong
+              + weight * this->ToolongAt(lower + 1, stations_count);
+    }
+    if (toolong <= 0.0) {
+      answer.station_count = stations_count;
+      answer.toolong_fraction = toolong;
+      answer.extrapolated = outside;
+      break;
+    }
+  }
+  if (answer.extrapolated && (answer.station_count > max_station_count_)) {
+    answer.toolong_fraction = this->ToolongAt(lower, max_station_count_);
+  }
+  answer.wait_mean_seconds = this->GetWaitMean(expected_voters,
+                                               answer.station_count);
+  return answer;
+}
+
+/****************************************************************
+ * Function ToString
+ * Returns a description of the grid.
+**/
+string ResponseSurface::ToString() const {
+  string s = "grid " + Utils::Format(this->GetGridPoints(), 4) + " points";
+  if (!voters_.empty()) {
+    s += " voters " + Utils::Format(voters_.front(), 6) + " to "
+       + Utils::Format(voters_.back(), 6);
+  }
+  s += " stations to " + Utils::Format(max_station_count_, 4);
+  return s;
+}
+
+/****************************************************************
+ * Private functions.
+**/
+/****************************************************************
+ * Function FindBracket
+ * Sets 'lower' to the grid point at or below the voters and
+ * 'weight' to how far the voters are toward the next point.
+ * Voters outside the grid use the nearest end and set 'outside'.
+**/
+void ResponseSurface::FindBracket(int expected_voters, int& lower,
+                                  double& weight, bool& outside) const {
+  lower = 0;
+  weight = 0.0;
+  outside = (expected_voters < voters_.front()) ||
+            (expected_voters > voters_.back());
+  if (expected_voters <= voters_.front())
+    return;
+  if (expected_voters >= voters_.back()) {
+    lower = static_cast<int>(voters_.size()) - 1;
+    return;
+  }
+
+  auto upper = upper_bound(voters_.begin(), voters_.end(), expected_voters);
+  lower = static_cast<int>(upper - voters_.begin()) - 1;
+  weight = static_cast<double>(expected_voters - voters_.at(lower)) /
+           static_cast<double>(voters_.at(lower + 1) - voters_.at(lower));
+}
+
+/****************************************************************
+ * Function ToolongAt
+ * Returns the too-long fraction at a grid point and station
+ * count: 1 below the simulated counts, 0 above a good-enough
+ * count, and 1 above the last count if none was good enough.
+**/
+double ResponseSurface::ToolongAt(int point, int stations_count) const {
+  int sub = stations_count - first_simulated_.at(point);
+  if (sub < 0)
+    return 1.0;
+  if (sub < static_cast<int>(toolong_fraction_.at(point).size()))
+    return toolong_fraction_.at(point).at(sub);
+  return (first_good_enough_.at(point) > 0) ? 0.0 : 1.0;
+}
+
+/****************************************************************
+ * Function WaitMeanAt
+ * Returns the mean wait at a grid point and station count, using
+ * the nearest simulated count outside the simulated range.
+**/
+double ResponseSurface::WaitMeanAt(int point, int stations_count) const {
+  int last = static_cast<int>(wait_mean_seconds_.at(point).size()) - 1;
+  int sub = stations_count - first_simulated_.at(point);
+  sub = max(0, min(last, sub));
+  return wait_mean_seconds_.at(point).at(sub);
+}
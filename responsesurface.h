@@ -0,0 +1,87 @@
+/****************************************************************
+ * Header for the 'ResponseSurface' class.
+ *
+ * A ResponseSurface is a table of simulated results over a grid
+ * of expected-voter counts and station counts: for each point,
+ * the mean wait and the fraction of voters who waited too long,
+ * averaged over number_of_iterations_ iterations. Each grid
+ * point is simulated the way RunSimulationPct would simulate a
+ * precinct of that size, from its minimum station count up to
+ * the first count at which no voter waits too long.
+ *
+ * Once built, the table answers "how many stations, and what
+ * wait" for any number of expected voters by interpolating
+ * linearly between the two nearest grid points, which takes
+ * microseconds instead of a simulation.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef RESPONSESURFACE_H
+#define RESPONSESURFACE_H
+
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "configuration.h"
+
+class ResponseSurface {
+public:
+/****************************************************************
+ * The answer to one query. 'extrapolated' is set when the
+ * voters were outside the grid or no grid station count was
+ * good enough, so the answer is a guess at the edge of the table.
+**/
+ struct Answer {
+   int station_count = 0;
+   double wait_mean_seconds = 0.0;
+   double toolong_fraction = 0.0;
+   bool extrapolated = false;
+ };
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ ResponseSurface() = default;
+ virtual ~ResponseSurface() = default;
+
+/****************************************************************
+ * Accessors.
+**/
+ int GetGridPoints() const;
+ int GetMaxStationCount() const;
+ double GetWaitMean(int expected_voters, int stations_count) const;
+
+/****************************************************************
+ * General functions. Build() simulates the grid, using up to
+ * 'thread_count' threads; Query() answers from it.
+**/
+ void Build(const Configuration& config, int grid_points, int thread_count);
+ Answer Query(int expected_voters) const;
+ string ToString() const;
+
+private:
+ int max_station_count_ = 0;
+ vector<int> voters_;
+ vector<int> first_simulated_;
+ vector<int> first_good_enough_;
+ vector<vector<double> > toolong_fraction_;
+ vector<vector<double> > wait_mean_seconds_;
+
+/****************************************************************
+ * Private functions to read one grid point, filling in station
+ * counts that were not simulated from the nearest that was.
+**/
+ void FindBracket(int expected_voters, int& lower, double& weight,
+                  bool& outside) const;
+ double ToolongAt(int point, int stations_count) const;
+ double WaitMeanAt(int point, int stations_count) const;
+};
+
+#endif // RESPONSESURFACE_H
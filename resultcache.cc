@@ -0,0 +1,213 @@
+#include "resultcache.h"
+/****************************************************************
+ * Implementation for the 'ResultCache' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * Each line of the cache file is a key written as 16 hex digits
+ * followed by a PctResult record. Lines that do not read back
+ * as a record (a line cut short by a crash, say) are skipped;
+ * if a key appears twice the later line wins.
+ *
+**/
+
+#include <iomanip>
+#include <sstream>
+
+/****************************************************************
+ * Function ToStringKey
+ * Returns a key as 16 hex digits.
+**/
+static string ToStringKey(unsigned long long key) {
+  ostringstream outstream;
+  outstream << hex << setw(16) << setfill('0') << key;
+  return outstream.str();
+}
+
+/****************************************************************
+ * Destructor.
+**/
+ResultCache::~ResultCache() {
+  this->Close();
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetHits
+ * Returns how many Find() calls found a result.
+**/
+int ResultCache::GetHits() const {
+  unique_lock<mutex> lock(mutex_);
+  return hits_;
+}
+
+/****************************************************************
+ * Function GetMisses
+ * Returns how many Find() calls did not find a result.
+**/
+int ResultCache::GetMisses() const {
+  unique_lock<mutex> lock(mutex_);
+  return misses_;
+}
+
+/****************************************************************
+ * Function IsOpen
+ * Returns true once OpenFile() or OpenMemory() has been called.
+**/
+bool ResultCache::IsOpen() const {
+  return is_open_;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function SetConfiguration
+ * Records the configuration inputs and the digest of the
+ * service-time table once, so GetKey() need not recompute them
+ * for every precinct.
+**/
+void ResultCache::SetConfiguration(const Configuration& config) {
+  string service_times = "";
+  for (auto iter = config.actual_service_times_.begin();
+            iter != config.actual_service_times_.end(); ++iter) {
+    service_times += to_string(*iter) + " ";
+  }
+  config_inputs_ = config.ToStringSimulationInputs() + " services "
+                 + ToStringKey(Hash(service_times));
+}
+
+/****************************************************************
+ * Function LoadFile
+ * Adds the results a cache file holds, a later line for a key
+ * replacing an earlier one, and returns false if there is no
+ * such file.
+**/
+bool ResultCache::LoadFile(string filename) {
+  ifstream instream(filename.c_str());
+  if (!instream)
+    return false;
+
+  string line;
+  while (getline(instream, line)) {
+    istringstream linestream(line);
+    string key_string;
+    linestream >> key_string;
+    if (16 != key_string.size())
+      continue;
+
+    string record;
+    getline(linestream, record);
+    PctResult result;
+    if (result.ReadRecord(record)) {
+      results_[stoull(key_string, nullptr, 16)] = result;
+    }
+  }
+  instream.close();
+  is_open_ = true;
+  return true;
+}
+
+/****************************************************************
+ * Function OpenFile
+ * Loads whatever results the file already holds and opens it
+ * for appending new ones. A missing file is an empty cache.
+**/
+void ResultCache::OpenFile(string filename) {
+  filename_ = filename;
+  this->LoadFile(filename);
+
+  append_stream_.open(filename.c_str(), ofstream::app);
+  if (!append_stream_) {
+    cout << "CACHE: ERROR opening cache file '" << filename << "'" << endl;
+    exit(1);
+  }
+  is_open_ = true;
+}
+
+/****************************************************************
+ * Function OpenMemory
+ * Opens the cache with no file behind it.
+**/
+void ResultCache::OpenMemory() {
+  filename_ = "";
+  is_open_ = true;
+}
+
+/****************************************************************
+ * Function Close
+ * Closes the cache file.
+**/
+void ResultCache::Close() {
+  if (append_stream_.is_open())
+    append_stream_.close();
+}
+
+/****************************************************************
+ * Function GetKey
+ * Returns the key for a precinct drawing from RN stream 'stream'
+ * under the configuration given to SetConfiguration().
+**/
+unsigned long long ResultCache::GetKey(const OnePct& pct,
+                                       unsigned long long stream) const {
+  return Hash(pct.ToStringWorkload() + " | " + config_inputs_
+              + " | stream " + to_string(stream));
+}
+
+/****************************************************************
+ * Function Find
+ * Copies the result filed under 'key' into 'result' and returns
+ * true, or returns false if there is none.
+**/
+bool ResultCache::Find(unsigned long long key, PctResult& result) {
+  unique_lock<mutex> lock(mutex_);
+  auto iter = results_.find(key);
+  if (iter == results_.end()) {
+    ++misses_;
+    return false;
+  }
+  ++hits_;
+  result = iter->second;
+  return true;
+}
+
+/****************************************************************
+ * Function Store
+ * Files a result under 'key' and appends it to the cache file.
+**/
+void ResultCache::Store(unsigned long long key, const PctResult& result) {
+  unique_lock<mutex> lock(mutex_);
+  results_[key] = result;
+  if (append_stream_.is_open())
+    append_stream_ << ToStringKey(key) << " " << result.ToStringRecord() << endl;
+}
+
+/****************************************************************
+ * Function ToString
+ * Returns the file name, if any, with the hit and miss counts.
+**/
+string ResultCache::ToString() const {
+  unique_lock<mutex> lock(mutex_);
+  string s = "";
+  if (!filename_.empty())
+    s += "'" + filename_ + "' ";
+  s += "hits " + Utils::Format(hits_, 6)
+     + " misses " + Utils::Format(misses_, 6);
+  return s;
+}
+
+/****************************************************************
+ * Function Hash
+ * Returns the 64-bit FNV-1a hash of 'text'.
+**/
+unsigned long long ResultCache::Hash(const string& text) {
+  unsigned long long hash = 14695981039346656037ULL;
+  for (auto iter = text.begin(); iter != text.end(); ++iter) {
+    hash ^= static_cast<unsigned char>(*iter);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
@@ -0,0 +1,84 @@
+/****************************************************************
+ * Header for the 'ResultCache' class.
+ *
+ * A ResultCache keeps PctResults on disk from one run to the
+ * next. Each result is filed under a key that is a hash of
+ * everything the result depends on: the precinct's workload
+ * (expected voters and stations to histogram), the fields of
+ * the configuration that the simulation uses, a digest of the
+ * service-time table, and the number of the RN stream the
+ * precinct draws from. A precinct whose key is already in the
+ * cache need not be simulated again.
+ *
+ * The file is plain text, one result per line, and is only ever
+ * appended to, so an interrupted run keeps what it finished. A
+ * cache opened with OpenMemory() has no file and lasts for one
+ * run; it serves as a memo table of results already worked out.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "configuration.h"
+#include "onepct.h"
+#include "pctresult.h"
+
+class ResultCache {
+public:
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ ResultCache() = default;
+ virtual ~ResultCache();
+
+/****************************************************************
+ * Accessors.
+**/
+ int GetHits() const;
+ int GetMisses() const;
+ bool IsOpen() const;
+
+/****************************************************************
+ * General functions. SetConfiguration() must be called before
+ * GetKey(). Find() and Store() may be called from any thread.
+ * LoadFile() reads the results of a cache file, such as a shard's,
+ * into a cache without opening the file for appending.
+**/
+ void SetConfiguration(const Configuration& config);
+ bool LoadFile(string filename);
+ void OpenFile(string filename);
+ void OpenMemory();
+ void Close();
+
+ unsigned long long GetKey(const OnePct& pct, unsigned long long stream) const;
+ bool Find(unsigned long long key, PctResult& result);
+ void Store(unsigned long long key, const PctResult& result);
+
+ string ToString() const;
+ static unsigned long long Hash(const string& text);
+
+private:
+ string config_inputs_ = "";
+ string filename_ = "";
+ int hits_ = 0;
+ int misses_ = 0;
+ bool is_open_ = false;
+ map<unsigned long long, PctResult> results_;
+ mutable mutex mutex_;
+ ofstream append_stream_;
+};
+
+#endif // RESULTCACHE_H
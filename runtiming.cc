@@ -0,0 +1,190 @@
+#include "runtiming.h"
+/****************************************************************
+ * Implementation for the 'RunTiming' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * The percentiles are taken as QueryServer takes its latencies':
+ * the times sorted, and the one at the rounded rank.
+ *
+**/
+
+#include <algorithm>
+#include <climits>
+#include <map>
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Bucket
+ * Returns the bucket of a precinct with 'expected_voters'.
+**/
+int RunTiming::Bucket(int expected_voters) {
+  int bucket = 0;
+  long long top = kFirstBucketVoters;
+  while (expected_voters >= top) {
+    ++bucket;
+    top *= 2;
+  }
+  return bucket;
+}
+
+/****************************************************************
+ * Function Record
+ * Keeps the time of a precinct and of each station count its
+ * result simulated, or only counts it if it was reused.
+**/
+void RunTiming::Record(int pct_number, int expected_voters,
+                       const PctResult& result, bool simulated,
+                       double seconds) {
+  lock_guard<mutex> lock(mutex_);
+  if (!simulated) {
+    ++pcts_reused_;
+    return;
+  }
+
+  PctTime pct;
+  pct.pct_number = pct_number;
+  pct.expected_voters = expected_voters;
+  pct.seconds = seconds;
+  for (auto iter = result.stations_.begin();
+            iter != result.stations_.end(); ++iter) {
+    if (iter == result.stations_.begin())
+      pct.stations_min = iter->station_count;
+    pct.stations_max = iter->station_count;
+    if (iter->screened)
+      continue;
+
+    StationTime station;
+    station.expected_voters = expected_voters;
+    station.station_count = iter->station_count;
+    station.seconds = iter->wall_seconds;
+    stations_.push_back(station);
+    voters_simulated_ += static_cast<long long>(expected_voters)
+                       * iter->iterations.size();
+  }
+  pcts_.push_back(pct);
+}
+
+/****************************************************************
+ * Function ToStringBucket
+ * Returns the range of expected voters of a bucket.
+**/
+string RunTiming::ToStringBucket(int bucket) {
+  long long low = (0 == bucket) ? 0
+                                : kFirstBucketVoters * (1LL << (bucket - 1));
+  long long high = min(kFirstBucketVoters * (1LL << bucket) - 1,
+                      static_cast<long long>(INT_MAX));
+  return "voters " + Utils::Format(static_cast<int>(low), 6) + "-"
+       + Utils::Format(static_cast<int>(high), 6);
+}
+
+/****************************************************************
+ * Function ToStringPercentiles
+ * Returns the median, 95th percentile and longest of the times
+ * in 'ms', which it sorts.
+**/
+string RunTiming::ToStringPercentiles(vector<double>& ms) {
+  sort(ms.begin(), ms.end());
+  int last = static_cast<int>(ms.size()) - 1;
+  return " ms p50 " + Utils::Format(ms.at(last / 2), 10, 2)
+       + " p95 " + Utils::Format(ms.at((95 * last + 50) / 100), 10, 2)
+       + " max " + Utils::Format(ms.at(last), 10, 2);
+}
+
+/****************************************************************
+ * Function ToStringStations
+ * Returns a line for each bucket of expected voters and station
+ * count simulated, with the times of those simulations.
+**/
+string RunTiming::ToStringStations(const string& tag) const {
+  map<pair<int, int>, vector<double> > ms;
+  {
+    lock_guard<mutex> lock(mutex_);
+    for (auto iter = stations_.begin(); iter != stations_.end(); ++iter) {
+      ms[make_pair(Bucket(iter->expected_voters), iter->station_count)]
+          .push_back(1000.0 * iter->seconds);
+    }
+  }
+
+  string s = "";
+  for (auto iter = ms.begin(); iter != ms.end(); ++iter) {
+    s += tag + "TIMING STATIONS " + ToStringBucket(iter->first.first)
+       + Utils::Format(iter->first.second, 4) + " stations runs "
+       + Utils::Format(static_cast<int>(iter->second.size()), 6)
+       + ToStringPercentiles(iter->second) + "\n";
+  }
+  return s;
+}
+
+/****************************************************************
+ * Function ToStringSummary
+ * Returns the lines of the timing summary: the totals and the
+ * voters simulated a second, the precinct times by bucket, the
+ * slowest precincts, and how many went over 'budget_ms'.
+**/
+string RunTiming::ToStringSummary(const string& tag, double wall_seconds,
+                                  int budget_ms) const {
+  vector<PctTime> pcts;
+  int pcts_reused = 0;
+  long long voters_simulated = 0;
+  {
+    lock_guard<mutex> lock(mutex_);
+    pcts = pcts_;
+    pcts_reused = pcts_reused_;
+    voters_simulated = voters_simulated_;
+  }
+
+  double busy_seconds = 0.0;
+  map<int, vector<double> > ms;
+  for (auto iter = pcts.begin(); iter != pcts.end(); ++iter) {
+    busy_seconds += iter->seconds;
+    ms[Bucket(iter->expected_voters)].push_back(1000.0 * iter->seconds);
+  }
+
+  string s = tag + "TIMING precincts "
+           + Utils::Format(static_cast<int>(pcts.size()) + pcts_reused, 6)
+           + " simulated " + Utils::Format(static_cast<int>(pcts.size()), 6)
+           + " reused " + Utils::Format(pcts_reused, 6)
+           + " wall " + Utils::Format(wall_seconds, 10, 2) + " s"
+           + " busy " + Utils::Format(busy_seconds, 10, 2) + " s"
+           + " voters/s "
+           + Utils::Format(wall_seconds > 0.0 ? voters_simulated / wall_seconds
+                                              : 0.0, 12, 0) + "\n";
+  for (auto iter = ms.begin(); iter != ms.end(); ++iter) {
+    s += tag + "TIMING PRECINCTS " + ToStringBucket(iter->first)
+       + " precincts " + Utils::Format(static_cast<int>(iter->second.size()), 6)
+       + ToStringPercentiles(iter->second) + "\n";
+  }
+
+  // The slowest first, ties by precinct number.
+  sort(pcts.begin(), pcts.end(), [](const PctTime& a, const PctTime& b) {
+    if (a.seconds != b.seconds)
+      return a.seconds > b.seconds;
+    return a.pct_number < b.pct_number;
+  });
+  int overruns = 0;
+  for (int sub = 0; sub < static_cast<int>(pcts.size()); ++sub) {
+    double pct_ms = 1000.0 * pcts.at(sub).seconds;
+    bool overrun = (budget_ms > 0) && (pct_ms > budget_ms);
+    if (overrun)
+      ++overruns;
+    if (sub >= kSlowestCount)
+      continue;
+    s += tag + "TIMING SLOWEST " + Utils::Format(sub + 1, 3)
+       + " pct " + Utils::Format(pcts.at(sub).pct_number, 4)
+       + " voters " + Utils::Format(pcts.at(sub).expected_voters, 6)
+       + " stations " + Utils::Format(pcts.at(sub).stations_min, 3) + "-"
+       + Utils::Format(pcts.at(sub).stations_max, 3)
+       + " ms " + Utils::Format(pct_ms, 10, 2)
+       + (overrun ? " OVERRUN" : "") + "\n";
+  }
+  if (budget_ms > 0) {
+    s += tag + "TIMING BUDGET " + Utils::Format(budget_ms, 8)
+       + " ms a precinct, overruns " + Utils::Format(overruns, 6)
+       + " of " + Utils::Format(static_cast<int>(pcts.size()), 6) + "\n";
+  }
+  return s;
+}
@@ -0,0 +1,94 @@
+/****************************************************************
+ * Header for the 'RunTiming' class.
+ *
+ * A RunTiming keeps the wall time of every precinct a run
+ * evaluates and of every station count simulated for it, for a
+ * run that has a deadline to meet. Record() is called as each
+ * precinct is done, from whichever thread did it, and takes a
+ * lock; the summaries are written at the end of the run.
+ *
+ * Precincts are put in buckets by their expected voters, the
+ * first under kFirstBucketVoters and each after that twice as
+ * wide as the one before. ToStringSummary() gives the median,
+ * 95th percentile and longest precinct time in each bucket, the
+ * kSlowestCount slowest precincts, the voters simulated per
+ * second of the run and, if there is a time budget for a
+ * precinct, how many went over it. ToStringStations() gives the
+ * same percentiles for each bucket and station count. Precincts
+ * whose result was reused from a cache, the memo table or a shard
+ * are counted but not timed, and a station count the prescreen
+ * screened out is not a simulation. The voters simulated are the
+ * expected voters times the iterations, summed over the station
+ * counts simulated.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef RUNTIMING_H
+#define RUNTIMING_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "pctresult.h"
+
+class RunTiming {
+public:
+ static const int kFirstBucketVoters = 250;
+ static const int kSlowestCount = 10;
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ RunTiming() = default;
+ virtual ~RunTiming() = default;
+
+/****************************************************************
+ * General functions. Record() takes a precinct's number and
+ * expected voters, its result, whether it was simulated rather
+ * than reused, and the seconds it took. The summaries start each
+ * line with 'tag'; 'wall_seconds' is the length of the run and
+ * 'budget_ms' the time budget for a precinct, or 0 for none.
+**/
+ void Record(int pct_number, int expected_voters, const PctResult& result,
+             bool simulated, double seconds);
+ string ToStringStations(const string& tag) const;
+ string ToStringSummary(const string& tag, double wall_seconds,
+                        int budget_ms) const;
+
+private:
+/****************************************************************
+ * The time of one precinct and of one station count simulated.
+**/
+ struct PctTime {
+   int pct_number = 0;
+   int expected_voters = 0;
+   int stations_min = 0;
+   int stations_max = 0;
+   double seconds = 0.0;
+ };
+ struct StationTime {
+   int expected_voters = 0;
+   int station_count = 0;
+   double seconds = 0.0;
+ };
+
+ int pcts_reused_ = 0;
+ long long voters_simulated_ = 0;
+ vector<PctTime> pcts_;
+ vector<StationTime> stations_;
+ mutable mutex mutex_;
+
+ static int Bucket(int expected_voters);
+ static string ToStringBucket(int bucket);
+ static string ToStringPercentiles(vector<double>& ms);
+};
+
+#endif // RUNTIMING_H
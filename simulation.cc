@@ -15,6 +15,20 @@
  *
  **/
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+
+#include "queryserver.h"
+#include "resultcache.h"
+#include "responsesurface.h"
+#include "stationbudget.h"
+#include "threadpool.h"
+
 static const string kTag = "SIM: ";
 
 /****************************************************************
@@ -40,6 +54,236 @@ void Simulation::ReadPrecincts(Scanner& infile) {
   } // while (infile.HasNext()) {
 } // void Simulation::ReadPrecincts(Scanner& infile) {
 
+/****************************************************************
+ * Function: ReadPrecincts
+ * Same as above, but from a memory-mapped FastScanner, which is
+ * what main uses for large precinct files.
+ **/
+void Simulation::ReadPrecincts(FastScanner& infile) {
+  while (infile.HasNext()) {
+    OnePct new_pct;
+    new_pct.ReadData(infile);
+    pcts_[new_pct.GetPctNumber()] = new_pct;
+  } // while (infile.HasNext()) {
+} // void Simulation::ReadPrecincts(FastScanner& infile) {
+
+/****************************************************************
+ * Function RunBudget
+ * Builds the curve of every precinct in pcts_ that passes the
+ * min/max filter, on up to 'threads' threads, and then has a
+ * StationBudget spread 'budget' stations over them. Each curve
+ * draws from a stream of its own, derived from the precinct's
+ * GetStreamId(), even with rng=shared, so curves can be built in
+ * any order. Curves go through the memo table and result cache
+ * like results do, under their own stream number, so a second
+ * allocation of the same county needs no simulation at all.
+ **/
+void Simulation::RunBudget(const Configuration& config,
+                           OutputSink& sink) {
+  string outstring = "XX";
+  this->OpenCaches(config);
+
+  vector<OnePct> budgeted;
+  for (auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct) {
+    if (IsToBeSimulated(iterPct->second, config))
+      budgeted.push_back(iterPct->second);
+  }
+
+  auto build_start = chrono::steady_clock::now();
+  vector<future<PctResult> > curves;
+  {
+    ThreadPool pool(config.thread_count_);
+    for (auto iter = budgeted.begin(); iter != budgeted.end(); ++iter) {
+      OnePct pct = *iter;
+      const Configuration* the_config = &config;
+      curves.push_back(pool.Submit([this, pct, the_config]() mutable {
+        unsigned long long stream = ResultCache::Hash("budget "
+                                  + to_string(GetStreamId(pct, *the_config)));
+        unsigned long long key = 0;
+        if (memo_.IsOpen())
+          key = memo_.GetKey(pct, stream);
+        else if (cache_.IsOpen())
+          key = cache_.GetKey(pct, stream);
+
+        PctResult curve;
+        bool found = memo_.IsOpen() && memo_.Find(key, curve);
+        if (!found && cache_.IsOpen())
+          found = cache_.Find(key, curve);
+        if (!found) {
+          MyRandom curve_random(the_config->seed_, stream);
+          curve = pct.ComputeCurve(*the_config, curve_random);
+          if (cache_.IsOpen())
+            cache_.Store(key, curve);
+        }
+        if (memo_.IsOpen())
+          memo_.Store(key, curve);
+        return curve;
+      }));
+    }
+  }
+
+  StationBudget budget;
+  for (UINT sub = 0; sub < budgeted.size(); ++sub) {
+    budget.AddPrecinct(budgeted.at(sub), curves.at(sub).get());
+  }
+  double build_seconds = chrono::duration<double>(
+                         chrono::steady_clock::now() - build_start).count();
+  outstring = kTag + "BUDGET curves for " + Utils::Format((int)budgeted.size(), 5)
+            + " precincts built in " + Utils::Format(build_seconds, 8, 2)
+            + " seconds\n";
+  sink.Output(outstring);
+
+  auto allocate_start = chrono::steady_clock::now();
+  bool feasible = budget.Allocate(config.budget_);
+  double allocate_seconds = chrono::duration<double>(
+                            chrono::steady_clock::now() - allocate_start).count();
+  if (!feasible) {
+    outstring = kTag + "BUDGET ERROR budget " + Utils::Format(config.budget_, 6)
+              + " is less than the minimum "
+              + Utils::Format(budget.GetMinimumBudget(), 6) + "\n";
+    sink.Output(outstring);
+    this->ReportCaches(sink);
+    return;
+  }
+
+  const vector<StationBudget::Allocation>& allocations = budget.GetAllocations();
+  for (UINT sub = 0; sub < allocations.size(); ++sub) {
+    const StationBudget::Allocation& allocation = allocations.at(sub);
+    outstring = kTag + "BUDGET " + budgeted.at(sub).ToString()
+              + Utils::Format(allocation.station_count, 4)
+              + " stations, mean wait (mins) "
+              + Utils::Format(allocation.wait_mean_seconds/60.0, 8, 2)
+              + " toolong "
+              + Utils::Format(allocation.toolong_voters, 8, 1) + " "
+              + Utils::Format(100.0*allocation.toolong_voters/
+                              allocation.expected_voters, 6, 2) + "\n";
+    sink.Output(outstring);
+  }
+  outstring = kTag + "BUDGET TOTAL budget " + Utils::Format(config.budget_, 6)
+            + " " + budget.ToString() + "\n";
+  outstring += kTag + "BUDGET allocated in "
+            + Utils::Format(1000.0 * allocate_seconds, 10, 3)
+            + " milliseconds\n";
+  sink.Output(outstring);
+  this->ReportCaches(sink);
+} // void Simulation::RunBudget()
+
+/****************************************************************
+ * Function RunServer
+ * Answers queries about the precincts in pcts_ from stdin, or
+ * from the Unix domain socket named by 'serve', until told to
+ * stop, and then writes how many were answered and how fast.
+ **/
+void Simulation::RunServer(const Configuration& config,
+                           OutputSink& sink) {
+  QueryServer server(config, pcts_);
+  if ("stdin" == config.serve_)
+    server.ServeStream(cin, cout);
+  else
+    server.ServeSocket(config.serve_);
+  sink.Output(kTag + "SERVER " + server.ToStringSummary() + "\n");
+} // void Simulation::RunServer()
+
+/****************************************************************
+ * Function RunArrivalsCheck
+ * Tests order statistics arrivals against the chain of gaps on
+ * each precinct to be simulated, and writes how many differ.
+ **/
+void Simulation::RunArrivalsCheck(const Configuration& config,
+                                  MyRandom& random, OutputSink& sink) {
+  int differ = 0;
+
+  int pct_count_this_batch = 0;
+  for (auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct) {
+    OnePct pct = iterPct->second;
+    if (!IsToBeSimulated(pct, config))
+      continue;
+
+    ++pct_count_this_batch;
+    if (config.UsesSharedRandom()) {
+      pct.RunArrivalsCheck(config, random, sink, differ);
+    }
+    else {
+      MyRandom pct_random(config.seed_, GetStreamId(pct, config));
+      pct.RunArrivalsCheck(config, pct_random, sink, differ);
+    }
+  }
+
+  string outstring = kTag + "ARRIVALS precincts whose arrivals differ at 1% "
+                   + Utils::Format(differ, 4) + " of "
+                   + Utils::Format(pct_count_this_batch, 4) + "\n";
+  sink.Output(outstring);
+  sink.Output(ToStringPctCount(pct_count_this_batch));
+} // void Simulation::RunArrivalsCheck()
+
+/****************************************************************
+ * Function RunKernelBench
+ * Times the general loops against the specialised kernels on
+ * each precinct to be simulated, and writes the total speedup.
+ **/
+void Simulation::RunKernelBench(const Configuration& config,
+                                MyRandom& random, OutputSink& sink) {
+  double generic_ms = 0.0;
+  double kernel_ms = 0.0;
+
+  int pct_count_this_batch = 0;
+  for (auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct) {
+    OnePct pct = iterPct->second;
+    if (!IsToBeSimulated(pct, config))
+      continue;
+
+    ++pct_count_this_batch;
+    if (config.UsesSharedRandom()) {
+      pct.RunKernelBench(config, random, sink, generic_ms, kernel_ms);
+    }
+    else {
+      MyRandom pct_random(config.seed_, GetStreamId(pct, config));
+      pct.RunKernelBench(config, pct_random, sink, generic_ms, kernel_ms);
+    }
+  }
+
+  string outstring = kTag + "KERNEL general " + Utils::Format(generic_ms, 10, 1)
+                   + " ms kernels " + Utils::Format(kernel_ms, 10, 1)
+                   + " ms speedup ";
+  if (kernel_ms > 0.0)
+    outstring += Utils::Format(generic_ms / kernel_ms, 7, 2) + "x";
+  sink.Output(outstring + "\n");
+  sink.Output(ToStringPctCount(pct_count_this_batch));
+} // void Simulation::RunKernelBench()
+
+/****************************************************************
+ * Function RunSchedules
+ * Runs every schedule given in the configuration on each
+ * precinct in pcts_ that passes the min/max filter. With
+ * rng=shared the precincts draw from 'random' in order;
+ * otherwise each draws from its own stream.
+ **/
+void Simulation::RunSchedules(const Configuration& config, MyRandom& random,
+                              OutputSink& sink) {
+  string outstring = "XX";
+
+  int pct_count_this_batch = 0;
+  for (auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct) {
+    OnePct pct = iterPct->second;
+    if (!IsToBeSimulated(pct, config))
+      continue;
+
+    ++pct_count_this_batch;
+    outstring = kTag + "RunSchedules for pct " + "\n";
+    outstring += kTag + pct.ToString() + "\n";
+    sink.Output(outstring);
+
+    if (config.UsesSharedRandom()) {
+      pct.RunSchedules(config, random, sink);
+    }
+    else {
+      MyRandom pct_random(config.seed_, GetStreamId(pct, config));
+      pct.RunSchedules(config, pct_random, sink);
+    }
+  }
+  sink.Output(ToStringPctCount(pct_count_this_batch));
+} // void Simulation::RunSchedules()
+
 /****************************************************************
  * Function RunSimulation
  * Written by Alexander Reeser {
@@ -52,33 +296,110 @@ void Simulation::ReadPrecincts(Scanner& infile) {
  * After the loop ends, the number of pcts in the simulation is
  * sent to the Output.
  * } endReeser
+ * With a checkpoint, each precinct's output is saved as it is
+ * finished, with its result when it draws from its own stream,
+ * and precincts saved by an earlier run that died are written
+ * from the checkpoint instead of being simulated again.
+ * With a shard, only the shard's precincts are simulated.
  **/
 void Simulation::RunSimulation(const Configuration &config, MyRandom &random,
-                               ofstream &out_stream) {
-  string outstring = "XX";
+                               OutputSink& sink) {
+  auto run_start = chrono::steady_clock::now();
+  this->OpenCaches(config);
+  this->OpenSeries(config);
+  if (!config.trace_filename_.empty() && !trace_.IsOpen())
+    trace_.OpenFile(config.trace_filename_);
+
+  bool checkpointing = !config.checkpoint_filename_.empty();
+  if (checkpointing) {
+    // The run is named by the configuration its output starts with.
+    Configuration named = config;
+    checkpoint_.Open(config.checkpoint_filename_,
+                     ResultCache::Hash(named.ToString()));
+    string state = checkpoint_.GetRandomState();
+    if (!state.empty() && ("-" != state) && !random.ReadState(state)) {
+      cout << kTag << "ERROR bad RN state in checkpoint '"
+           << config.checkpoint_filename_ << "'" << endl;
+      exit(1);
+    }
+  }
+
+  bool own_stream = !config.UsesSharedRandom() &&
+                    config.toolong_sweep_.empty();
+
+  set<int> shard_pcts;
+  if (config.shard_count_ > 0)
+    shard_pcts = this->ShardPrecincts(config, sink);
+
   int pct_count_this_batch = 0;
   for (auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct) {
     OnePct pct = iterPct->second;
 
-    int expected_voters = pct.GetExpectedVoters();
-    if ((expected_voters <= config.min_expected_to_simulate_) ||
-        (expected_voters > config.max_expected_to_simulate_))
+    if (!IsToBeSimulated(pct, config))
+      continue;
+    if ((config.shard_count_ > 0) && (0 == shard_pcts.count(iterPct->first)))
       continue;
-
-    outstring = kTag + "RunSimulation for pct " + "\n";
-    outstring += kTag + pct.ToString() + "\n";
-    Utils::Output(outstring, out_stream, Utils::log_stream);
 
     ++pct_count_this_batch;
-    pct.RunSimulationPct(config, random, out_stream);
+    if (!checkpointing) {
+      this->SimulatePct(pct, config, random, sink);
+      continue;
+    }
+
+    // A precinct finished before the restart is written as it was;
+    // the RN state saved after it is already in 'random'. Its result
+    // goes through the memo table as it did the first time, so that
+    // the precincts after it find it there just the same.
+    BufferSink output;
+    string record = "";
+    if (checkpoint_.Restore(pct_count_this_batch - 1, pct.GetPctNumber(),
+                            output, record)) {
+      if (!record.empty()) {
+        PctResult restored;
+        PctResult result;
+        if (!restored.ReadRecord(record)) {
+          cout << kTag << "ERROR bad result for precinct "
+               << pct.GetPctNumber() << " in checkpoint '"
+               << config.checkpoint_filename_ << "'" << endl;
+          exit(1);
+        }
+        this->SimulatePctOwnStream(pct, config, result, &restored);
+      }
+      output.FlushTo(sink);
+      continue;
+    }
+    BufferSink buffer;
+    PctResult result = this->SimulatePct(pct, config, random, buffer);
+    checkpoint_.Record(pct.GetPctNumber(), buffer,
+                       own_stream ? result.ToStringRecord() : "");
+    buffer.FlushTo(sink);
+    if (0 == pct_count_this_batch % config.checkpoint_every_) {
+      checkpoint_.Mark(pct_count_this_batch, config.UsesSharedRandom() ?
+                                             random.ToStringState() : "-");
+    }
 
     //    break; // we only run one pct right now
   } // for(auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct)
 
-  outstring = kTag + "PRECINCT COUNT THIS BATCH " +
-              Utils::Format(pct_count_this_batch, 4) + "\n";
+  if (checkpointing) {
+    checkpoint_.Mark(pct_count_this_batch, config.UsesSharedRandom() ?
+                                           random.ToStringState() : "-");
+    // How many were restored goes only to the console, so that the
+    // files of a restarted run are those of one that never stopped.
+    sink.Output(kTag + "CHECKPOINT " + checkpoint_.ToString() + "\n");
+    cout << kTag << "CHECKPOINT restored "
+         << checkpoint_.GetRestoredCount() << " precincts" << endl;
+    checkpoint_.Close();
+  }
+
   //  Utils::Output(outstring, out_stream);
-  Utils::Output(outstring, out_stream, Utils::log_stream);
+  sink.Output(ToStringPctCount(pct_count_this_batch));
+  this->ReportCaches(sink);
+  this->ReportSeries(sink);
+  this->ReportTrace(sink);
+  this->ReportTiming(config, chrono::duration<double>(
+                         chrono::steady_clock::now() - run_start).count(),
+                     sink);
   //  out_stream << outstring << endl;
   //  out_stream.flush();
   //  Utils::log_stream << outstring << endl;
@@ -86,6 +407,649 @@ void Simulation::RunSimulation(const Configuration &config, MyRandom &random,
 
 } // void Simulation::RunSimulation()
 
+/****************************************************************
+ * Function RunSimulationStreaming
+ * Reads precincts from 'infile' one at a time and simulates each
+ * one that passes the min/max filter, without filling pcts_.
+ *
+ * With a single shared RN stream the precincts must be done in
+ * order, one after another, so only one precinct is ever held.
+ * With a stream per precinct (rng=precinct) each precinct is
+ * handed to a pool of 'threads' workers, which write into their
+ * own buffers; at most 'stream' precincts are in flight at once,
+ * and the buffers are written out in input order. Either way
+ * memory does not grow with the number of precincts.
+ *
+ * Precincts come out in file order rather than sorted by number
+ * as ReadPrecincts() would leave them, and a repeated precinct
+ * number is simulated each time it appears.
+ **/
+void Simulation::RunSimulationStreaming(FastScanner& infile,
+                                        const Configuration& config,
+                                        MyRandom& random, OutputSink& sink) {
+  auto run_start = chrono::steady_clock::now();
+  this->OpenCaches(config);
+  this->OpenSeries(config);
+  if (!config.trace_filename_.empty() && !trace_.IsOpen())
+    trace_.OpenFile(config.trace_filename_);
+
+  int pct_count_this_batch = 0;
+
+  if (config.UsesSharedRandom() || (1 == config.thread_count_)) {
+    while (infile.HasNext()) {
+      OnePct pct;
+      pct.ReadData(infile);
+      if (!IsToBeSimulated(pct, config))
+        continue;
+
+      ++pct_count_this_batch;
+      this->SimulatePct(pct, config, random, sink);
+    }
+  }
+  else {
+    ThreadPool pool(config.thread_count_);
+    deque<future<shared_ptr<BufferSink> > > in_flight;
+    while (infile.HasNext()) {
+      OnePct pct;
+      pct.ReadData(infile);
+      if (!IsToBeSimulated(pct, config))
+        continue;
+
+      ++pct_count_this_batch;
+      const Configuration* the_config = &config;
+      in_flight.push_back(pool.Submit([this, pct, the_config]() mutable {
+        shared_ptr<BufferSink> buffer = make_shared<BufferSink>();
+        MyRandom unused_random;
+        this->SimulatePct(pct, *the_config, unused_random, *buffer);
+        return buffer;
+      }));
+
+      if (static_cast<int>(in_flight.size()) >= config.stream_window_) {
+        in_flight.front().get()->FlushTo(sink);
+        in_flight.pop_front();
+      }
+    }
+    while (!in_flight.empty()) {
+      in_flight.front().get()->FlushTo(sink);
+      in_flight.pop_front();
+    }
+  }
+
+  sink.Output(ToStringPctCount(pct_count_this_batch));
+  this->ReportCaches(sink);
+  this->ReportSeries(sink);
+  this->ReportTrace(sink);
+  this->ReportTiming(config, chrono::duration<double>(
+                         chrono::steady_clock::now() - run_start).count(),
+                     sink);
+} // void Simulation::RunSimulationStreaming()
+
+/****************************************************************
+ * Function RunSurface
+ * Builds a response surface for the configuration and answers
+ * each precinct in pcts_ that passes the min/max filter from it
+ * with a station count and mean wait. Then 'surface_checks'
+ * precincts, spread evenly over those answered, are simulated in
+ * full as RunSimulationPct would, each from its own RN stream,
+ * and the surface's answers for them are compared with the
+ * simulated ones to give the error of the surface.
+ **/
+void Simulation::RunSurface(const Configuration& config,
+                            OutputSink& sink) {
+  string outstring = "XX";
+
+  auto build_start = chrono::steady_clock::now();
+  ResponseSurface surface;
+  surface.Build(config, config.surface_points_, config.thread_count_);
+  double build_seconds = chrono::duration<double>(
+                         chrono::steady_clock::now() - build_start).count();
+  outstring = kTag + "SURFACE " + surface.ToString() + " built in "
+            + Utils::Format(build_seconds, 8, 2) + " seconds\n";
+  sink.Output(outstring);
+
+  vector<OnePct> answered;
+  vector<ResponseSurface::Answer> answers;
+  auto query_start = chrono::steady_clock::now();
+  for (auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct) {
+    if (!IsToBeSimulated(iterPct->second, config))
+      continue;
+    answered.push_back(iterPct->second);
+    answers.push_back(surface.Query(iterPct->second.GetExpectedVoters()));
+  }
+  double query_seconds = chrono::duration<double>(
+                         chrono::steady_clock::now() - query_start).count();
+
+  for (UINT sub = 0; sub < answered.size(); ++sub) {
+    outstring = kTag + "SURFACE " + answered.at(sub).ToString()
+              + Utils::Format(answers.at(sub).station_count, 4)
+              + " stations, mean wait (mins) "
+              + Utils::Format(answers.at(sub).wait_mean_seconds/60.0, 8, 2)
+              + " toolong "
+              + Utils::Format(100.0*answers.at(sub).toolong_fraction, 6, 2)
+              + (answers.at(sub).extrapolated ? " EXTRAPOLATED" : "") + "\n";
+    sink.Output(outstring);
+  }
+  double micros = answered.empty() ? 0.0
+                : 1.0e6 * query_seconds / answered.size();
+  outstring = kTag + "SURFACE " + Utils::Format((int)answered.size(), 6)
+            + " queries, " + Utils::Format(micros, 10, 3)
+            + " microseconds each\n";
+  sink.Output(outstring);
+
+  ////////////////////////////////////////////////////////////////////
+  // spot checks against full simulations
+  int check_count = min(config.surface_checks_, (int)answered.size());
+  int stations_agree = 0;
+  int stations_worst = 0;
+  double wait_error_sum = 0.0;
+  double wait_error_worst = 0.0;
+  for (int check = 0; check < check_count; ++check) {
+    int sub = (check_count > 1)
+            ? check * ((int)answered.size() - 1) / (check_count - 1) : 0;
+    OnePct pct = answered.at(sub);
+    MyRandom pct_random(config.seed_, GetStreamId(pct, config));
+    PctResult result = pct.ComputeResult(config, pct_random);
+
+    const PctResult::StationStats& last = result.stations_.back();
+    double wait_sum = 0.0;
+    for (auto stats = last.iterations.begin();
+              stats != last.iterations.end(); ++stats) {
+      wait_sum += stats->wait_mean_seconds;
+    }
+    double simulated_wait = wait_sum / last.iterations.size();
+    double surface_wait = surface.GetWaitMean(pct.GetExpectedVoters(),
+                                              last.station_count);
+    int station_error = answers.at(sub).station_count - last.station_count;
+    double wait_error = fabs(surface_wait - simulated_wait) / 60.0;
+
+    if (0 == station_error)
+      ++stations_agree;
+    stations_worst = max(stations_worst, abs(station_error));
+    wait_error_sum += wait_error;
+    wait_error_worst = max(wait_error_worst, wait_error);
+
+    outstring = kTag + "SURFACE CHECK " + Utils::Format(pct.GetPctNumber(), 4)
+              + Utils::Format(pct.GetExpectedVoters(), 6)
+              + " simulated " + Utils::Format(last.station_count, 4)
+              + " stations " + Utils::Format(simulated_wait/60.0, 8, 2)
+              + " surface " + Utils::Format(answers.at(sub).station_count, 4)
+              + " stations " + Utils::Format(surface_wait/60.0, 8, 2) + "\n";
+    sink.Output(outstring);
+  }
+  if (check_count > 0) {
+    outstring = kTag + "SURFACE ERROR stations agree "
+              + Utils::Format(stations_agree, 4) + " of "
+              + Utils::Format(check_count, 4) + ", worst by "
+              + Utils::Format(stations_worst, 3)
+              + "; mean wait error (mins) mean "
+              + Utils::Format(wait_error_sum / check_count, 8, 2)
+              + " worst " + Utils::Format(wait_error_worst, 8, 2) + "\n";
+    sink.Output(outstring);
+  }
+} // void Simulation::RunSurface()
+
+/****************************************************************
+ * Function RunSweepSpec
+ * Simulates every precinct in pcts_ under every configuration in
+ * 'configs', all as (configuration, precinct) pairs on one pool
+ * of 'threads' workers from 'config'. The precincts and service
+ * times were loaded once, by main, and each configuration is a
+ * copy that differs only in the fields its sweep_label_ names.
+ *
+ * Each pair draws from its own stream, as with rng=precinct,
+ * whatever 'rng' says, and is simulated as RunSimulationPct would
+ * be; the filter is each configuration's own. Reports come out
+ * configuration by configuration, in precinct order, every line
+ * tagged with the configuration's number, followed by a summary
+ * line per configuration. No more than 'stream' pairs, or four
+ * per thread, are held at once.
+ **/
+void Simulation::RunSweepSpec(const vector<Configuration>& configs,
+                              const Configuration& config,
+                              OutputSink& sink) {
+  typedef pair<shared_ptr<BufferSink>, PctResult> PairResult;
+  string outstring = "XX";
+
+  for (UINT sub = 0; sub < configs.size(); ++sub) {
+    outstring = kTag + "SWEEPSPEC CONFIG " + Utils::Format((int)sub, 4)
+              + " " + configs.at(sub).sweep_label_ + "\n";
+    sink.Output(outstring);
+  }
+
+  int window = max(config.stream_window_, 4 * config.thread_count_);
+  vector<int> pct_counts(configs.size(), 0);
+  vector<int> station_totals(configs.size(), 0);
+  vector<double> wait_totals(configs.size(), 0.0);
+  vector<string> tags;
+  for (UINT sub = 0; sub < configs.size(); ++sub) {
+    tags.push_back("[" + to_string(sub) + "] ");
+  }
+
+  auto start = chrono::steady_clock::now();
+  int pair_count = 0;
+  {
+    ThreadPool pool(config.thread_count_);
+    deque<pair<int, future<PairResult> > > in_flight;
+
+    // Writes the oldest pair's report and adds it to its totals.
+    auto flush_oldest = [&]() {
+      int which = in_flight.front().first;
+      PairResult done = in_flight.front().second.get();
+      in_flight.pop_front();
+
+      TaggedSink tagged(sink, tags.at(which));
+      done.first->FlushTo(tagged);
+      const PctResult::StationStats& last = done.second.stations_.back();
+      double wait_sum = 0.0;
+      for (auto stats = last.iterations.begin();
+                stats != last.iterations.end(); ++stats) {
+        wait_sum += stats->wait_mean_seconds;
+      }
+      ++pct_counts.at(which);
+      station_totals.at(which) += last.station_count;
+      wait_totals.at(which) += wait_sum / last.iterations.size();
+    };
+
+    for (UINT which = 0; which < configs.size(); ++which) {
+      const Configuration* the_config = &configs.at(which);
+      for (auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct) {
+        if (!IsToBeSimulated(iterPct->second, *the_config))
+          continue;
+
+        ++pair_count;
+        OnePct pct = iterPct->second;
+        in_flight.push_back(make_pair(which,
+            pool.Submit([pct, the_config]() mutable {
+          shared_ptr<BufferSink> buffer = make_shared<BufferSink>();
+          string header = kTag + "RunSimulation for pct " + "\n";
+          header += kTag + pct.ToString() + "\n";
+          buffer->Output(header);
+
+          MyRandom pct_random(the_config->seed_,
+                              GetStreamId(pct, *the_config));
+          PctResult result = pct.ComputeResult(*the_config, pct_random);
+          pct.ReportResult(result, *the_config, *buffer);
+          return PairResult(buffer, result);
+        })));
+
+        if (static_cast<int>(in_flight.size()) >= window)
+          flush_oldest();
+      }
+    }
+    while (!in_flight.empty()) {
+      flush_oldest();
+    }
+  }
+  double seconds = chrono::duration<double>(
+                   chrono::steady_clock::now() - start).count();
+
+  for (UINT sub = 0; sub < configs.size(); ++sub) {
+    double mean_wait = (pct_counts.at(sub) > 0)
+                     ? wait_totals.at(sub) / pct_counts.at(sub) : 0.0;
+    outstring = kTag + "SWEEPSPEC CONFIG " + Utils::Format((int)sub, 4)
+              + " precincts " + Utils::Format(pct_counts.at(sub), 5)
+              + " stations " + Utils::Format(station_totals.at(sub), 6)
+              + " mean wait (mins) " + Utils::Format(mean_wait/60.0, 8, 2)
+              + " : " + configs.at(sub).sweep_label_ + "\n";
+    sink.Output(outstring);
+  }
+  outstring = kTag + "SWEEPSPEC " + Utils::Format((int)configs.size(), 5)
+            + " configurations, " + Utils::Format(pair_count, 6)
+            + " pairs in " + Utils::Format(seconds, 8, 2) + " seconds\n";
+  sink.Output(outstring);
+} // void Simulation::RunSweepSpec()
+
+/****************************************************************
+ * Function OpenCaches
+ * Opens the result cache if the configuration names one, and
+ * the in-memory memo table if precincts draw from workload
+ * streams.
+ **/
+void Simulation::OpenCaches(const Configuration& config) {
+  if (!config.cache_filename_.empty() && !cache_.IsOpen()) {
+    cache_.SetConfiguration(config);
+    cache_.OpenFile(config.cache_filename_);
+  }
+  if (("workload" == config.rng_streams_) && !memo_.IsOpen()) {
+    memo_.SetConfiguration(config);
+    memo_.OpenMemory();
+  }
+  if (!config.merge_filenames_.empty() && !merged_.IsOpen()) {
+    merged_.SetConfiguration(config);
+    for (auto iter = config.merge_filenames_.begin();
+              iter != config.merge_filenames_.end(); ++iter) {
+      if (!merged_.LoadFile(*iter)) {
+        cout << kTag << "ERROR cannot read shard results '" << *iter << "'"
+             << endl;
+        exit(1);
+      }
+    }
+  }
+}
+
+/****************************************************************
+ * Function OpenSeries
+ * Opens the queue series file if the configuration names one
+ * and writes its CSV header.
+ **/
+void Simulation::OpenSeries(const Configuration& config) {
+  if (config.series_filename_.empty() || series_stream_.is_open())
+    return;
+  Utils::FileOpen(series_stream_, config.series_filename_);
+  series_stream_ << QueueSeries::ToStringCsvHeader("pct,stations,");
+}
+
+/****************************************************************
+ * Function RecordSeries
+ * Writes the queue series of every station count of a result to
+ * the series file and merges the series of the count the
+ * precinct settled on into the county's. Precincts simulated on
+ * worker threads may come in any order.
+ **/
+void Simulation::RecordSeries(const OnePct& pct, const PctResult& result) {
+  if (!series_stream_.is_open() || result.stations_.empty())
+    return;
+  string rows = "";
+  for (auto iter = result.stations_.begin();
+            iter != result.stations_.end(); ++iter) {
+    rows += iter->series.ToStringCsv(to_string(pct.GetPctNumber()) + ","
+                                     + to_string(iter->station_count) + ",");
+  }
+
+  lock_guard<mutex> lock(series_mutex_);
+  series_stream_ << rows;
+  county_series_.Merge(result.stations_.back().series);
+}
+
+/****************************************************************
+ * Function RecordTrace
+ * Appends the voter trace blocks of every station count of a
+ * result to the trace file.
+**/
+void Simulation::RecordTrace(const PctResult& result) {
+  if (!trace_.IsOpen())
+    return;
+  for (auto iter = result.stations_.begin();
+            iter != result.stations_.end(); ++iter) {
+    trace_.Write(iter->trace);
+  }
+}
+
+/****************************************************************
+ * Function ReportCaches
+ * Writes the hit and miss counts of the memo table and cache,
+ * for those in use.
+ **/
+void Simulation::ReportCaches(OutputSink& sink) {
+  if (memo_.IsOpen())
+    sink.Output(kTag + "MEMO " + memo_.ToString() + "\n");
+  if (cache_.IsOpen())
+    sink.Output(kTag + "CACHE " + cache_.ToString() + "\n");
+}
+
+/****************************************************************
+ * Function ReportSeries
+ * Writes the county's queue series hour by hour, the sum over
+ * the precincts at the station counts they settled on, and
+ * closes the series file.
+ **/
+void Simulation::ReportSeries(OutputSink& sink) {
+  if (!series_stream_.is_open())
+    return;
+  sink.Output(county_series_.ToStringHourly(kTag + "SERIES COUNTY "),
+              OutputSink::kDetail);
+  series_stream_.close();
+}
+
+/****************************************************************
+ * Function ReportTiming
+ * Writes the wall times of the precincts simulated, if timing or
+ * a time budget was asked for: the summary, and as detail the
+ * times by station count.
+**/
+void Simulation::ReportTiming(const Configuration& config,
+                              double wall_seconds, OutputSink& sink) {
+  if (!config.timing_ && (0 == config.time_budget_ms_))
+    return;
+  sink.Output(timing_.ToStringSummary(kTag, wall_seconds,
+                                      config.time_budget_ms_));
+  sink.Output(timing_.ToStringStations(kTag), OutputSink::kDetail);
+}
+
+/****************************************************************
+ * Function ReportTrace
+ * Writes how much the voter trace holds and closes it.
+**/
+void Simulation::ReportTrace(OutputSink& sink) {
+  if (!trace_.IsOpen())
+    return;
+  trace_.Close();
+  sink.Output(kTag + "TRACE " + trace_.ToString() + "\n");
+}
+
+/****************************************************************
+ * Function GetStreamId
+ * Returns the number of the RN stream a precinct draws from when
+ * it does not share the run's stream. With rng=precinct that is
+ * its precinct number. With rng=workload it is a hash of the
+ * precinct's workload, so precincts with the same workload draw
+ * the same numbers and have the same result.
+ **/
+unsigned long long Simulation::GetStreamId(const OnePct& pct,
+                                           const Configuration& config) {
+  if ("workload" == config.rng_streams_)
+    return ResultCache::Hash(pct.ToStringWorkload());
+  return static_cast<unsigned long long>(pct.GetPctNumber());
+}
+
+/****************************************************************
+ * Function IsToBeSimulated
+ * Returns true if the precinct's expected voters are in the
+ * range (min, max] given by the configuration.
+ **/
+bool Simulation::IsToBeSimulated(const OnePct& pct,
+                                 const Configuration& config) {
+  int expected_voters = pct.GetExpectedVoters();
+  if ((expected_voters <= config.min_expected_to_simulate_) ||
+      (expected_voters > config.max_expected_to_simulate_))
+    return false;
+  return true;
+}
+
+/****************************************************************
+ * Function ShardPrecincts
+ * Returns the numbers of the precincts in this run's shard. The
+ * precincts to be simulated are dealt out biggest first, each to
+ * the shard with the least work so far (the lowest-numbered one
+ * on a tie), taking the work of a precinct to go as its expected
+ * voters times the iterations. Every shard of a run deals the
+ * same way, so the shards cover the precincts exactly once. The
+ * shard's share is written to 'sink'.
+ **/
+set<int> Simulation::ShardPrecincts(const Configuration& config,
+                                    OutputSink& sink) const {
+  typedef pair<long long, int> Load;
+
+  vector<pair<long long, int> > costs;
+  for (auto iterPct = pcts_.begin(); iterPct != pcts_.end(); ++iterPct) {
+    if (!IsToBeSimulated(iterPct->second, config))
+      continue;
+    long long cost = static_cast<long long>(iterPct->second.GetExpectedVoters())
+                   * config.number_of_iterations_;
+    costs.push_back(make_pair(-cost, iterPct->first));
+  }
+  sort(costs.begin(), costs.end());
+
+  priority_queue<Load, vector<Load>, greater<Load> > loads;
+  for (int shard = 1; shard <= config.shard_count_; ++shard) {
+    loads.push(Load(0, shard));
+  }
+  set<int> shard_pcts;
+  long long shard_cost = 0;
+  long long total_cost = 0;
+  for (auto iter = costs.begin(); iter != costs.end(); ++iter) {
+    Load least = loads.top();
+    loads.pop();
+    least.first -= iter->first;
+    loads.push(least);
+    total_cost -= iter->first;
+    if (config.shard_index_ == least.second) {
+      shard_pcts.insert(iter->second);
+      shard_cost -= iter->first;
+    }
+  }
+
+  string outstring = kTag + "SHARD " + to_string(config.shard_index_) + "/"
+                   + to_string(config.shard_count_) + " precincts "
+                   + Utils::Format((int)shard_pcts.size(), 6) + " of "
+                   + Utils::Format((int)costs.size(), 6) + " work "
+                   + Utils::Format(100.0 * shard_cost
+                                   / max(1LL, total_cost), 6, 2) + "%\n";
+  sink.Output(outstring);
+  return shard_pcts;
+}
+
+/****************************************************************
+ * Function SimulatePct
+ * Writes the precinct header and runs the precinct's simulation.
+ * Unless rng=shared the precinct draws from its own stream, see
+ * GetStreamId(), and 'random' is not touched. A result is then
+ * looked for first in the memo table of this run and then in the
+ * result cache; only if neither has it is the precinct simulated,
+ * and the new result goes into both. The report lines are always
+ * written with this precinct's own labels. A toolong sweep needs
+ * the histograms that results in the cache do not keep, so it
+ * always simulates.
+ * The wall time of the whole precinct goes into timing_, and a
+ * precinct that takes longer than the time budget is flagged
+ * after its lines. Returns the precinct's result.
+ **/
+PctResult Simulation::SimulatePct(OnePct& pct, const Configuration& config,
+                             MyRandom& random, OutputSink& sink) {
+  auto started = chrono::steady_clock::now();
+  string outstring = "XX";
+  outstring = kTag + "RunSimulation for pct " + "\n";
+  outstring += kTag + pct.ToString() + "\n";
+  sink.Output(outstring);
+
+  PctResult result;
+  bool simulated = true;
+  if (!config.toolong_sweep_.empty()) {
+    if (config.UsesSharedRandom()) {
+      result = pct.RunToolongSweep(config, random, sink);
+    }
+    else {
+      MyRandom pct_random(config.seed_, GetStreamId(pct, config));
+      result = pct.RunToolongSweep(config, pct_random, sink);
+    }
+    // The series and trace are those of the station counts the
+    // precinct's own 'too long' settles on, as a plain run would record.
+    if (series_stream_.is_open() || trace_.IsOpen()) {
+      int toolong = config.wait_time_minutes_that_is_too_long_;
+      PctResult own = result.Rescore(toolong);
+      this->RecordSeries(pct, own);
+      this->RecordTrace(own);
+    }
+  }
+  else if (config.UsesSharedRandom()) {
+    result = pct.ComputeResult(config, random);
+    this->RecordSeries(pct, result);
+    this->RecordTrace(result);
+    pct.ReportResult(result, config, sink);
+  }
+  else {
+    simulated = this->SimulatePctOwnStream(pct, config, result);
+    pct.ReportResult(result, config, sink);
+  }
+
+  double seconds = chrono::duration<double>(
+                       chrono::steady_clock::now() - started).count();
+  timing_.Record(pct.GetPctNumber(), pct.GetExpectedVoters(), result,
+                 simulated, seconds);
+  if ((config.time_budget_ms_ > 0) &&
+      (1000.0 * seconds > config.time_budget_ms_)) {
+    sink.Output(kTag + "OVERRUN pct " + Utils::Format(pct.GetPctNumber(), 4)
+                + " voters " + Utils::Format(pct.GetExpectedVoters(), 6)
+                + " ms " + Utils::Format(1000.0 * seconds, 10, 2)
+                + " budget " + Utils::Format(config.time_budget_ms_, 8)
+                + " ms\n");
+  }
+  return result;
+}
+
+/****************************************************************
+ * Function SimulatePctOwnStream
+ * Finds the result of a precinct that draws from its own stream:
+ * from the memo table, the result cache or the shards being
+ * merged, or by simulating it. Returns true if it was simulated.
+ * A 'restored' result, saved by a checkpoint, stands in for the
+ * simulation, so the memo table and cache get it as they would
+ * have had it been simulated now.
+ **/
+bool Simulation::SimulatePctOwnStream(OnePct& pct,
+                                      const Configuration& config,
+                                      PctResult& result,
+                                      const PctResult* restored) {
+  unsigned long long stream = GetStreamId(pct, config);
+  unsigned long long key = 0;
+  if (memo_.IsOpen())
+    key = memo_.GetKey(pct, stream);
+  else if (cache_.IsOpen())
+    key = cache_.GetKey(pct, stream);
+  else if (merged_.IsOpen())
+    key = merged_.GetKey(pct, stream);
+
+  // A series, trace or voters' text is only made by simulating, so
+  // none is reused.
+  bool reuse = config.series_filename_.empty() &&
+               config.trace_filename_.empty() && !config.WantsVoters();
+  bool found = reuse && memo_.IsOpen() && memo_.Find(key, result);
+  if (!found && reuse && cache_.IsOpen()) {
+    found = cache_.Find(key, result);
+    if (found && memo_.IsOpen())
+      memo_.Store(key, result);
+  }
+  if (found)
+    return false;
+  if (merged_.IsOpen()) {
+    // Merging shards, the shards' result stands in for simulating.
+    if (!merged_.Find(key, result)) {
+      cout << kTag << "ERROR precinct " << pct.GetPctNumber()
+           << " is in none of the shard results" << endl;
+      exit(1);
+    }
+    if (memo_.IsOpen())
+      memo_.Store(key, result);
+    if (cache_.IsOpen())
+      cache_.Store(key, result);
+    return false;
+  }
+
+  if (nullptr != restored) {
+    result = *restored;
+  }
+  else {
+    MyRandom pct_random(config.seed_, stream);
+    result = pct.ComputeResult(config, pct_random);
+  }
+  if (memo_.IsOpen())
+    memo_.Store(key, result);
+  if (cache_.IsOpen())
+    cache_.Store(key, result);
+  this->RecordSeries(pct, result);
+  this->RecordTrace(result);
+  return true;
+}
+
+/****************************************************************
+ * Function ToStringPctCount
+ * Returns the line that closes a batch.
+ **/
+string Simulation::ToStringPctCount(int pct_count_this_batch) {
+  return kTag + "PRECINCT COUNT THIS BATCH " +
+         Utils::Format(pct_count_this_batch, 4) + "\n";
+}
+
 /****************************************************************
  * Function ToString
  * Returns: a string containing all the pct information in the 
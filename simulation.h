@@ -14,7 +14,10 @@
 #ifndef SIMULATION_H
 #define SIMULATION_H
 
+#include <fstream>
 #include <map>
+#include <set>
+#include <mutex>
 
 #include "../Utilities/utils.h"
 #include "../Utilities/scanner.h"
@@ -22,8 +25,16 @@
 
 using namespace std;
 
+#include "checkpoint.h"
 #include "configuration.h"
+#include "fastscanner.h"
 #include "onepct.h"
+#include "outputsink.h"
+#include "pctresult.h"
+#include "queueseries.h"
+#include "resultcache.h"
+#include "runtiming.h"
+#include "votertrace.h"
 
 class Simulation
 {
@@ -36,24 +47,82 @@ public:
 
   /****************************************************************
    * General functions to begin the simulation based on a random 
-   * seed paramter and using the configuration class and ofstream
-   * ToString() and ToStringPcts() format output for precincts
+   * seed paramter and using the configuration class and a sink
+   * ToString() and ToStringPcts() format output for precincts.
+   * RunSimulationStreaming() reads, simulates and writes the
+   * precincts of a file without ever holding them all in pcts_.
+   * RunSurface() answers every precinct from a ResponseSurface.
+   * RunBudget() spreads a county budget of stations over pcts_.
+   * RunKernelBench() times the simulation kernels on pcts_.
+   * RunArrivalsCheck() tests the two ways of making arrivals.
+   * RunSchedules() tries the configuration's station schedules on
+   * each precinct. RunSweepSpec() runs many configurations.
+   * RunServer() answers what-if queries about pcts_.
    **/
   void ReadPrecincts(Scanner& infile);
+  void ReadPrecincts(FastScanner& infile);
+  void RunArrivalsCheck(const Configuration& config, MyRandom& random,
+                        OutputSink& sink);
+  void RunBudget(const Configuration& config, OutputSink& sink);
+  void RunKernelBench(const Configuration& config, MyRandom& random,
+                      OutputSink& sink);
+  void RunServer(const Configuration& config, OutputSink& sink);
+  void RunSchedules(const Configuration& config, MyRandom& random,
+                    OutputSink& sink);
   void RunSimulation(const Configuration& config,
-                     MyRandom& random, ofstream& out_stream);
+                     MyRandom& random, OutputSink& sink);
+  void RunSimulationStreaming(FastScanner& infile, const Configuration& config,
+                              MyRandom& random, OutputSink& sink);
+  void RunSurface(const Configuration& config, OutputSink& sink);
+  void RunSweepSpec(const vector<Configuration>& configs,
+                    const Configuration& config, OutputSink& sink);
   string ToString();
   string ToStringPcts();
 
 private:
   /****************************************************************
-   * Variables, a map of all voter precincts. 
+   * Variables, a map of all voter precincts, the result cache
+   * kept on disk between runs, the memo table kept for one run,
+   * the results of the shards being merged,
+   * the queue series file with the county's merged series, the
+   * voter trace, the checkpoint of a restartable run, and the wall
+   * times of the precincts simulated.
    **/
   map<int, OnePct> pcts_;
+  ResultCache cache_;
+  ResultCache memo_;
+  ResultCache merged_;
+  QueueSeries county_series_;
+  mutex series_mutex_;
+  ofstream series_stream_;
+  Checkpoint checkpoint_;
+  VoterTrace trace_;
+  RunTiming timing_;
 
   /****************************************************************
    * Private functions.
    **/
+  void OpenCaches(const Configuration& config);
+  void OpenSeries(const Configuration& config);
+  void RecordSeries(const OnePct& pct, const PctResult& result);
+  void RecordTrace(const PctResult& result);
+  void ReportCaches(OutputSink& sink);
+  void ReportSeries(OutputSink& sink);
+  void ReportTiming(const Configuration& config, double wall_seconds,
+                    OutputSink& sink);
+  void ReportTrace(OutputSink& sink);
+  set<int> ShardPrecincts(const Configuration& config,
+                          OutputSink& sink) const;
+  PctResult SimulatePct(OnePct& pct, const Configuration& config,
+                        MyRandom& random, OutputSink& sink);
+  bool SimulatePctOwnStream(OnePct& pct, const Configuration& config,
+                            PctResult& result,
+                            const PctResult* restored = nullptr);
+
+  static unsigned long long GetStreamId(const OnePct& pct,
+                                        const Configuration& config);
+  static bool IsToBeSimulated(const OnePct& pct, const Configuration& config);
+  static string ToStringPctCount(int pct_count_this_batch);
 };
 
 #endif // SIMULATION_H
@@ -0,0 +1,203 @@
+#include "stationbudget.h"
+/****************************************************************
+ * Implementation for the 'StationBudget' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+ * Precinct 'p' has curve entries for the station counts
+ * first_station_count_[p] on up. A count past the end of its
+ * curve is taken to do no better than the last entry, so the
+ * greedy allocation never gives a precinct more stations than
+ * its curve reaches.
+ *
+**/
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetAllocations
+ * Returns the allocation made by the last Allocate().
+**/
+const vector<StationBudget::Allocation>& StationBudget::GetAllocations() const {
+  return allocations_;
+}
+
+/****************************************************************
+ * Function GetMinimumBudget
+ * Returns the stations needed to give every precinct its minimum.
+**/
+int StationBudget::GetMinimumBudget() const {
+  int minimum = 0;
+  for (auto iter = first_station_count_.begin();
+            iter != first_station_count_.end(); ++iter) {
+    minimum += *iter;
+  }
+  return minimum;
+}
+
+/****************************************************************
+ * Function GetStationsUsed
+ * Returns the stations handed out, which is less than the budget
+ * if every curve ran out first.
+**/
+int StationBudget::GetStationsUsed() const {
+  int used = 0;
+  for (auto iter = allocations_.begin(); iter != allocations_.end(); ++iter) {
+    used += iter->station_count;
+  }
+  return used;
+}
+
+/****************************************************************
+ * Function GetToolongVoters
+ * Returns the expected number of voters county-wide who wait too
+ * long under the allocation.
+**/
+double StationBudget::GetToolongVoters() const {
+  double voters = 0.0;
+  for (auto iter = allocations_.begin(); iter != allocations_.end(); ++iter) {
+    voters += iter->toolong_voters;
+  }
+  return voters;
+}
+
+/****************************************************************
+ * Function GetWaitVoterMinutes
+ * Returns the expected total minutes waited county-wide.
+**/
+double StationBudget::GetWaitVoterMinutes() const {
+  double minutes = 0.0;
+  for (auto iter = allocations_.begin(); iter != allocations_.end(); ++iter) {
+    minutes += iter->expected_voters * iter->wait_mean_seconds / 60.0;
+  }
+  return minutes;
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function AddPrecinct
+ * Adds a precinct with its curve, averaging each station count's
+ * iterations into a mean wait and a mean too-long count.
+**/
+void StationBudget::AddPrecinct(const OnePct& pct, const PctResult& curve) {
+  vector<double> waits;
+  vector<double> toolongs;
+  for (auto iter = curve.stations_.begin();
+            iter != curve.stations_.end(); ++iter) {
+    double wait_sum = 0.0;
+    double toolong_sum = 0.0;
+    for (auto stats = iter->iterations.begin();
+              stats != iter->iterations.end(); ++stats) {
+      wait_sum += stats->wait_mean_seconds;
+      toolong_sum += stats->toolong_count;
+    }
+    double iterations = static_cast<double>(iter->iterations.size());
+    waits.push_back(wait_sum / iterations);
+    toolongs.push_back(toolong_sum / iterations);
+  }
+
+  pct_numbers_.push_back(pct.GetPctNumber());
+  expected_voters_.push_back(pct.GetExpectedVoters());
+  first_station_count_.push_back(curve.stations_.front().station_count);
+  wait_mean_seconds_.push_back(waits);
+  toolong_voters_.push_back(toolongs);
+}
+
+/****************************************************************
+ * Function Allocate
+ * Gives every precinct its minimum and then hands out the rest
+ * of the budget one station at a time to the precinct whose next
+ * station gains the most. The gain is the pair (too-long voters
+ * saved, voter-minutes of waiting saved), compared in that order.
+ * A station that gains nothing, or that the noise of the curve
+ * says would leave more voters waiting too long, is not handed
+ * out.
+**/
+bool StationBudget::Allocate(int budget) {
+  typedef pair<pair<double, double>, int> Gain;
+
+  allocations_.clear();
+  if (budget < this->GetMinimumBudget())
+    return false;
+
+  int precinct_count = static_cast<int>(pct_numbers_.size());
+  vector<int> stations = first_station_count_;
+
+  // The gain of precinct 'p' going from 'stations[p]' to one more.
+  auto next_gain = [this, &stations](int precinct) {
+    Allocation now = this->AllocationAt(precinct, stations.at(precinct));
+    Allocation next = this->AllocationAt(precinct, stations.at(precinct) + 1);
+    double toolong_saved = now.toolong_voters - next.toolong_voters;
+    double minutes_saved = now.expected_voters *
+                  (now.wait_mean_seconds - next.wait_mean_seconds) / 60.0;
+    return Gain(make_pair(toolong_saved, minutes_saved), precinct);
+  };
+
+  priority_queue<Gain> best;
+  for (int precinct = 0; precinct < precinct_count; ++precinct) {
+    best.push(next_gain(precinct));
+  }
+
+  int remaining = budget - this->GetMinimumBudget();
+  while ((remaining > 0) && !best.empty()) {
+    Gain top = best.top();
+    best.pop();
+    if (top.first <= make_pair(0.0, 0.0))
+      continue;
+
+    int precinct = top.second;
+    ++stations.at(precinct);
+    --remaining;
+    best.push(next_gain(precinct));
+  }
+
+  for (int precinct = 0; precinct < precinct_count; ++precinct) {
+    allocations_.push_back(this->AllocationAt(precinct,
+                                              stations.at(precinct)));
+  }
+  return true;
+}
+
+/****************************************************************
+ * Function ToString
+ * Returns the county totals of the allocation.
+**/
+string StationBudget::ToString() const {
+  string s = "precincts " + Utils::Format((int)pct_numbers_.size(), 5)
+           + " stations " + Utils::Format(this->GetStationsUsed(), 6)
+           + " (minimum " + Utils::Format(this->GetMinimumBudget(), 6) + ")"
+           + " toolong voters " + Utils::Format(this->GetToolongVoters(), 10, 1)
+           + " wait voter-minutes "
+           + Utils::Format(this->GetWaitVoterMinutes(), 12, 1);
+  return s;
+}
+
+/****************************************************************
+ * Private functions.
+**/
+/****************************************************************
+ * Function AllocationAt
+ * Returns a precinct's figures at a station count, using the
+ * last entry of its curve for counts beyond it.
+**/
+StationBudget::Allocation StationBudget::AllocationAt(int precinct,
+                                              int stations_count) const {
+  Allocation allocation;
+  int last = static_cast<int>(wait_mean_seconds_.at(precinct).size()) - 1;
+  int sub = min(last, stations_count - first_station_count_.at(precinct));
+
+  allocation.pct_number = pct_numbers_.at(precinct);
+  allocation.expected_voters = expected_voters_.at(precinct);
+  allocation.station_count = stations_count;
+  allocation.wait_mean_seconds = wait_mean_seconds_.at(precinct).at(sub);
+  allocation.toolong_voters = toolong_voters_.at(precinct).at(sub);
+  return allocation;
+}
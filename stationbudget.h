@@ -0,0 +1,85 @@
+/****************************************************************
+ * Header for the 'StationBudget' class.
+ *
+ * A StationBudget spreads a fixed county inventory of voting
+ * stations across precincts. It is given each precinct's curve,
+ * a PctResult from OnePct::ComputeCurve() holding the mean wait
+ * and too-long count at every station count from the precinct's
+ * minimum up, and then allocates the budget greedily: every
+ * precinct starts at its minimum, and each further station goes
+ * to the precinct where it saves the most voters from waiting
+ * too long, and among equals the most voter-minutes of waiting.
+ * A priority queue keeps the best next station for each precinct,
+ * so an allocation takes microseconds per station and no
+ * simulation at all.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef STATIONBUDGET_H
+#define STATIONBUDGET_H
+
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "onepct.h"
+#include "pctresult.h"
+
+class StationBudget {
+public:
+/****************************************************************
+ * One precinct's share of the budget, with the averages over
+ * the iterations at that station count.
+**/
+ struct Allocation {
+   int pct_number = 0;
+   int expected_voters = 0;
+   int station_count = 0;
+   double wait_mean_seconds = 0.0;
+   double toolong_voters = 0.0;
+ };
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ StationBudget() = default;
+ virtual ~StationBudget() = default;
+
+/****************************************************************
+ * Accessors.
+**/
+ const vector<Allocation>& GetAllocations() const;
+ int GetMinimumBudget() const;
+ int GetStationsUsed() const;
+ double GetToolongVoters() const;
+ double GetWaitVoterMinutes() const;
+
+/****************************************************************
+ * General functions. Allocate() returns false, leaving no
+ * allocation, if the budget is less than GetMinimumBudget().
+**/
+ void AddPrecinct(const OnePct& pct, const PctResult& curve);
+ bool Allocate(int budget);
+ string ToString() const;
+
+private:
+ vector<Allocation> allocations_;
+ vector<int> expected_voters_;
+ vector<int> first_station_count_;
+ vector<int> pct_numbers_;
+ vector<vector<double> > toolong_voters_;
+ vector<vector<double> > wait_mean_seconds_;
+
+/****************************************************************
+ * Private functions.
+**/
+ Allocation AllocationAt(int precinct, int stations_count) const;
+};
+
+#endif // STATIONBUDGET_H
@@ -0,0 +1,74 @@
+#include "threadpool.h"
+/****************************************************************
+ * Implementation for the 'ThreadPool' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+/****************************************************************
+ * Constructor.
+ * Starts 'thread_count' workers, at least one.
+**/
+ThreadPool::ThreadPool(int thread_count) {
+  if (thread_count < 1)
+    thread_count = 1;
+  for (int i = 0; i < thread_count; ++i) {
+    workers_.push_back(thread(&ThreadPool::WorkerLoop, this));
+  }
+}
+
+/****************************************************************
+ * Destructor.
+ * Lets the workers drain the queue and then joins them.
+**/
+ThreadPool::~ThreadPool() {
+  {
+    unique_lock<mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (auto iter = workers_.begin(); iter != workers_.end(); ++iter) {
+    iter->join();
+  }
+}
+
+/****************************************************************
+ * Function GetThreadCount
+ * Returns the number of worker threads.
+**/
+int ThreadPool::GetThreadCount() const {
+  return static_cast<int>(workers_.size());
+}
+
+/****************************************************************
+ * Function Enqueue
+ * Adds a job to the queue and wakes one worker.
+**/
+void ThreadPool::Enqueue(function<void()> job) {
+  {
+    unique_lock<mutex> lock(mutex_);
+    tasks_.push(job);
+  }
+  condition_.notify_one();
+}
+
+/****************************************************************
+ * Function WorkerLoop
+ * Runs jobs until the pool is stopping and the queue is empty.
+**/
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    function<void()> job;
+    {
+      unique_lock<mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty())
+        return;
+      job = tasks_.front();
+      tasks_.pop();
+    }
+    job();
+  }
+}
@@ -0,0 +1,77 @@
+/****************************************************************
+ * Header for the 'ThreadPool' class.
+ *
+ * A fixed set of worker threads that run submitted tasks in the
+ * order they were submitted. Submit() hands back a future for
+ * the task's result, so a caller can collect results in any
+ * order it likes, usually the order of the input.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+class ThreadPool {
+public:
+/****************************************************************
+ * Constructors and destructors for the class. The destructor
+ * finishes every task already submitted before it returns.
+**/
+ ThreadPool(int thread_count);
+ virtual ~ThreadPool();
+
+/****************************************************************
+ * Accessors.
+**/
+ int GetThreadCount() const;
+
+/****************************************************************
+ * General functions.
+**/
+ template <typename Task>
+ future<typename result_of<Task()>::type> Submit(Task task);
+
+private:
+ bool stopping_ = false;
+ condition_variable condition_;
+ mutex mutex_;
+ queue<function<void()> > tasks_;
+ vector<thread> workers_;
+
+/****************************************************************
+ * Private functions.
+**/
+ void Enqueue(function<void()> job);
+ void WorkerLoop();
+};
+
+/****************************************************************
+ * Function Submit
+ * Queues 'task' and returns a future for whatever it returns.
+**/
+template <typename Task>
+future<typename result_of<Task()>::type> ThreadPool::Submit(Task task) {
+  typedef typename result_of<Task()>::type Result;
+  shared_ptr<packaged_task<Result()> > job =
+      make_shared<packaged_task<Result()> >(task);
+  future<Result> result = job->get_future();
+  this->Enqueue([job]() { (*job)(); });
+  return result;
+}
+
+#endif // THREADPOOL_H
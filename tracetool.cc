@@ -0,0 +1,116 @@
+/****************************************************************
+ * Main program for looking at a voter trace written with the
+ * 'trace=FILE' run option.
+ *
+ *   tracetool tracefile
+ * lists the blocks of the trace, one line per precinct, station
+ * count and iteration, and
+ *   tracetool tracefile pct stations iteration
+ * decodes the one block asked for into the table of voters that
+ * OnePct::ToStringVoterMap() writes, in order of arrival and
+ * numbered in that order, with the mean and longest wait.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "onevoter.h"
+#include "votertrace.h"
+
+static const string kTag = "TRACETOOL: ";
+
+int main(int argc, char *argv[])
+{
+  if ((2 != argc) && (5 != argc)) {
+    cout << "usage: " << argv[0] << " tracefile [pct stations iteration]"
+         << endl;
+    return 1;
+  }
+  string trace_filename = static_cast<string>(argv[1]);
+
+  vector<VoterTrace::Block> blocks;
+  if (!VoterTrace::ReadIndex(trace_filename, blocks)) {
+    cout << kTag << "ERROR '" << trace_filename
+         << "' is not a voter trace or is cut short" << endl;
+    return 1;
+  }
+
+  ////////////////////////////////////////////////////////////////////
+  // with no block asked for, list them all
+  if (2 == argc) {
+    long long voters = 0;
+    long long bytes = 0;
+    for (auto iter = blocks.begin(); iter != blocks.end(); ++iter) {
+      cout << kTag << "pct " << Utils::Format(iter->pct_number, 5)
+           << " stations " << Utils::Format(iter->station_count, 4)
+           << " iteration " << Utils::Format(iter->iteration, 4)
+           << " voters " << Utils::Format(iter->voter_count, 6)
+           << " bytes " << Utils::Format((int)iter->bytes, 8) << endl;
+      voters += iter->voter_count;
+      bytes += iter->bytes;
+    }
+    cout << kTag << "blocks " << Utils::Format((int)blocks.size(), 8)
+         << " voters " << Utils::Format((double)voters, 12, 0)
+         << " bytes/voter "
+         << Utils::Format(bytes / static_cast<double>(max(1LL, voters)), 6, 2)
+         << endl;
+    return 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////
+  // otherwise decode the one block asked for
+  int pct_number = atoi(argv[2]);
+  int stations_count = atoi(argv[3]);
+  int iteration = atoi(argv[4]);
+  auto found = blocks.begin();
+  while ((found != blocks.end()) &&
+         ((found->pct_number != pct_number) ||
+          (found->station_count != stations_count) ||
+          (found->iteration != iteration))) {
+    ++found;
+  }
+  if (found == blocks.end()) {
+    cout << kTag << "ERROR no pct " << pct_number << " stations "
+         << stations_count << " iteration " << iteration << " in '"
+         << trace_filename << "'" << endl;
+    return 1;
+  }
+
+  vector<VoterTrace::Voter> voters;
+  if (!VoterTrace::Decode(trace_filename, *found, voters)) {
+    cout << kTag << "ERROR block is cut short" << endl;
+    return 1;
+  }
+
+  cout << kTag << "pct " << pct_number << " stations " << stations_count
+       << " iteration " << iteration << " WITH "
+       << Utils::Format((int)voters.size(), 6) << " ENTRIES" << endl;
+  cout << OneVoter::ToStringHeader() << endl;
+  double wait_sum = 0.0;
+  int wait_max = 0;
+  for (int sub = 0; sub < static_cast<int>(voters.size()); ++sub) {
+    OneVoter one_voter(sub, voters[sub].arrival_seconds,
+                       voters[sub].duration_seconds);
+    one_voter.AssignStation(voters[sub].station, voters[sub].start_seconds);
+    cout << one_voter.ToString() << endl;
+
+    int wait = one_voter.GetTimeInQ();
+    wait_sum += wait;
+    wait_max = max(wait_max, wait);
+  }
+  cout << kTag << "wait (mins) mean "
+       << Utils::Format(wait_sum / max(1, (int)voters.size()) / 60.0, 8, 2)
+       << " max " << Utils::Format(wait_max / 60.0, 8, 2) << endl;
+
+  return 0;
+}
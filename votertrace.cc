@@ -0,0 +1,321 @@
+#include "votertrace.h"
+/****************************************************************
+ * Implementation for the 'VoterTrace' class.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#include <algorithm>
+#include <tuple>
+
+static const string kTag = "TRACE: ";
+static const string kMagic = "VTRACE1\n";
+
+/****************************************************************
+ * Function: AppendVarint
+ * Appends 'value' as an unsigned LEB128 varint, seven bits a byte,
+ * low bits first, the top bit set on all bytes but the last.
+**/
+static void AppendVarint(string& s, unsigned long long value) {
+  while (value >= 0x80) {
+    s += static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  s += static_cast<char>(value);
+}
+
+/****************************************************************
+ * Function: ParseVarint
+ * Reads a varint from 'next', no further than 'end', and moves
+ * 'next' past it. Returns false if it runs off the end.
+**/
+static bool ParseVarint(const char*& next, const char* end,
+                        unsigned long long& value) {
+  value = 0;
+  for (int shift = 0; (next < end) && (shift < 64); shift += 7) {
+    unsigned char byte = static_cast<unsigned char>(*next++);
+    value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+    if (0 == (byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+/****************************************************************
+ * Function: ParseHeader
+ * Reads the four numbers that start a block.
+**/
+static bool ParseHeader(const char*& next, const char* end,
+                        VoterTrace::Block& block) {
+  unsigned long long value[4];
+  for (int sub = 0; sub < 4; ++sub) {
+    if (!ParseVarint(next, end, value[sub]))
+      return false;
+  }
+  block.pct_number = static_cast<int>(value[0]);
+  block.station_count = static_cast<int>(value[1]);
+  block.iteration = static_cast<int>(value[2]);
+  block.voter_count = static_cast<int>(value[3]);
+  return true;
+}
+
+/****************************************************************
+ * Function: ReadVarint
+ * Reads a varint from a file. Returns false at the end of the file.
+**/
+static bool ReadVarint(istream& in, unsigned long long& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = in.get();
+    if (EOF == byte)
+      return false;
+    value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+    if (0 == (byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+/****************************************************************
+ * Destructor.
+**/
+VoterTrace::~VoterTrace() {
+  this->Close();
+}
+
+/****************************************************************
+ * Accessors and mutators.
+**/
+/****************************************************************
+ * Function GetBlocks
+ * Returns the number of blocks written.
+**/
+long long VoterTrace::GetBlocks() const {
+  lock_guard<mutex> lock(mutex_);
+  return blocks_;
+}
+
+/****************************************************************
+ * Function GetBytes
+ * Returns the number of bytes written, the file header included.
+**/
+long long VoterTrace::GetBytes() const {
+  lock_guard<mutex> lock(mutex_);
+  return bytes_;
+}
+
+/****************************************************************
+ * Function GetVoters
+ * Returns the number of voters written.
+**/
+long long VoterTrace::GetVoters() const {
+  lock_guard<mutex> lock(mutex_);
+  return voters_;
+}
+
+/****************************************************************
+ * Function IsOpen
+ * Returns true while a trace file is open for writing.
+**/
+bool VoterTrace::IsOpen() const {
+  return stream_.is_open();
+}
+
+/****************************************************************
+ * General functions.
+**/
+/****************************************************************
+ * Function Close
+ * Closes the trace file if it is open.
+**/
+void VoterTrace::Close() {
+  if (stream_.is_open())
+    stream_.close();
+}
+
+/****************************************************************
+ * Function Decode
+ * Reads the voters of one block listed by ReadIndex().
+**/
+bool VoterTrace::Decode(const string& filename, const Block& block,
+                        vector<Voter>& voters) {
+  voters.clear();
+  ifstream in(filename.c_str(), ios::binary);
+  if (!in)
+    return false;
+  string body(static_cast<size_t>(block.bytes), '\0');
+  in.seekg(block.offset);
+  if (!in.read(&body[0], block.bytes))
+    return false;
+
+  const char* next = body.data();
+  const char* end = next + body.size();
+  Block header;
+  if (!ParseHeader(next, end, header))
+    return false;
+
+  long long arrival = 0;
+  voters.reserve(header.voter_count);
+  for (int sub = 0; sub < header.voter_count; ++sub) {
+    unsigned long long value[4];
+    for (int field = 0; field < 4; ++field) {
+      if (!ParseVarint(next, end, value[field]))
+        return false;
+    }
+    // zigzag: 0, -1, 1, -2, ... are coded 0, 1, 2, 3, ...
+    long long delta = static_cast<long long>(value[0] >> 1)
+                    ^ -static_cast<long long>(value[0] & 1);
+    arrival += delta;
+
+    Voter voter;
+    voter.arrival_seconds = static_cast<int>(arrival);
+    voter.start_seconds = static_cast<int>(arrival + value[1]);
+    voter.duration_seconds = static_cast<int>(value[2]);
+    voter.station = static_cast<int>(value[3]);
+    voters.push_back(voter);
+  }
+  return true;
+}
+
+/****************************************************************
+ * Function EncodeIteration
+ * Returns the block for one iteration's voters, who are taken in
+ * order of arrival. The voters must all have voted.
+**/
+string VoterTrace::EncodeIteration(int pct_number, int stations_count,
+                                   int iteration,
+                                   const VoterMap& voters) {
+  vector<tuple<int, int, int, int> > ordered;
+  ordered.reserve(voters.size());
+  for (auto iter = voters.begin(); iter != voters.end(); ++iter) {
+    const OneVoter& voter = iter->second;
+    int start = voter.GetTimeArrival() + voter.GetTimeInQ();
+    ordered.push_back(make_tuple(voter.GetTimeArrival(), start,
+                                 voter.GetTimeDoneVoting() - start,
+                                 voter.GetStationNumber()));
+  }
+  sort(ordered.begin(), ordered.end());
+
+  string body = "";
+  body.reserve(8 + 6 * ordered.size());
+  AppendVarint(body, pct_number);
+  AppendVarint(body, stations_count);
+  AppendVarint(body, iteration);
+  AppendVarint(body, ordered.size());
+
+  long long previous = 0;
+  for (auto iter = ordered.begin(); iter != ordered.end(); ++iter) {
+    long long delta = get<0>(*iter) - previous;
+    previous = get<0>(*iter);
+    AppendVarint(body, (static_cast<unsigned long long>(delta) << 1)
+                       ^ static_cast<unsigned long long>(delta >> 63));
+    AppendVarint(body, get<1>(*iter) - get<0>(*iter));
+    AppendVarint(body, get<2>(*iter));
+    AppendVarint(body, get<3>(*iter));
+  }
+
+  string block = "";
+  AppendVarint(block, body.size());
+  return block + body;
+}
+
+/****************************************************************
+ * Function OpenFile
+ * Creates the trace file, replacing any there, and writes its
+ * header.
+**/
+void VoterTrace::OpenFile(const string& filename) {
+  stream_.open(filename.c_str(), ios::binary | ios::trunc);
+  if (!stream_) {
+    Utils::log_stream << kTag << "ERROR cannot open trace file '"
+                      << filename << "'" << endl;
+    cout << kTag << "ERROR cannot open trace file '" << filename << "'"
+         << endl;
+    exit(1);
+  }
+  stream_.write(kMagic.data(), kMagic.size());
+  bytes_ = kMagic.size();
+}
+
+/****************************************************************
+ * Function ReadIndex
+ * Lists the blocks of a trace file, reading only their headers.
+**/
+bool VoterTrace::ReadIndex(const string& filename, vector<Block>& blocks) {
+  blocks.clear();
+  ifstream in(filename.c_str(), ios::binary);
+  if (!in)
+    return false;
+  in.seekg(0, ios::end);
+  long long file_bytes = static_cast<long long>(in.tellg());
+  in.seekg(0, ios::beg);
+
+  string magic(kMagic.size(), '\0');
+  if (!in.read(&magic[0], magic.size()) || (kMagic != magic))
+    return false;
+
+  unsigned long long length = 0;
+  while (ReadVarint(in, length)) {
+    Block block;
+    block.offset = static_cast<long long>(in.tellg());
+    block.bytes = static_cast<long long>(length);
+    if (block.offset + block.bytes > file_bytes)
+      return false;
+
+    char header[40];
+    long long header_bytes = min(block.bytes, (long long)sizeof(header));
+    in.read(header, header_bytes);
+    const char* next = header;
+    if (!ParseHeader(next, header + header_bytes, block))
+      return false;
+    blocks.push_back(block);
+    in.seekg(block.offset + block.bytes);
+  }
+  return in.eof();
+}
+
+/****************************************************************
+ * Function ToString
+ * Returns what has been written, and the bytes per voter.
+**/
+string VoterTrace::ToString() const {
+  lock_guard<mutex> lock(mutex_);
+  string s = "blocks " + Utils::Format((int)blocks_, 8)
+           + " voters " + Utils::Format((double)voters_, 12, 0)
+           + " bytes " + Utils::Format((double)bytes_, 12, 0);
+  if (voters_ > 0) {
+    s += " bytes/voter "
+       + Utils::Format(static_cast<double>(bytes_) / voters_, 6, 2);
+  }
+  return s;
+}
+
+/****************************************************************
+ * Function Write
+ * Appends blocks made by EncodeIteration(), counting them and
+ * their voters.
+**/
+void VoterTrace::Write(const string& blocks) {
+  long long block_count = 0;
+  long long voter_count = 0;
+  const char* next = blocks.data();
+  const char* end = next + blocks.size();
+  unsigned long long length = 0;
+  while ((next < end) && ParseVarint(next, end, length)) {
+    const char* body = next;
+    Block block;
+    if (ParseHeader(body, end, block)) {
+      ++block_count;
+      voter_count += block.voter_count;
+    }
+    next += length;
+  }
+
+  lock_guard<mutex> lock(mutex_);
+  stream_.write(blocks.data(), blocks.size());
+  blocks_ += block_count;
+  bytes_ += blocks.size();
+  voters_ += voter_count;
+}
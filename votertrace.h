@@ -0,0 +1,112 @@
+/****************************************************************
+ * Header for the 'VoterTrace' class.
+ *
+ * A VoterTrace is a compact binary record of every voter of every
+ * iteration simulated, for looking at one precinct's voters after
+ * the fact without formatting every voter as text during the run.
+ *
+ * The file starts with the eight bytes "VTRACE1\n" and is then a
+ * run of blocks, one per precinct, station count and iteration.
+ * Every number is an unsigned LEB128 varint. A block is its length
+ * in bytes followed by
+ *   pct  stations  iteration  voters
+ * and then, for each voter in order of arrival,
+ *   arrival delta  wait  duration  station
+ * where the arrival delta is from the voter before (zigzag coded,
+ * in case a schedule ever puts arrivals before the polls open),
+ * so a voter takes about six bytes. Blocks from precincts run on
+ * different threads can come in any order, but each is whole and
+ * says what it is, and a reader skips from block to block by the
+ * lengths without decoding the voters.
+ *
+ * The writer side is EncodeIteration(), which is called on the
+ * worker threads, and OpenFile()/Write(), which append the blocks
+ * under a lock. The reader side is ReadIndex(), which lists the
+ * blocks of a file, and Decode(), which reads one of them.
+ *
+ * Author: agent
+ * Date: 18 October 2026
+ *
+**/
+
+#ifndef VOTERTRACE_H
+#define VOTERTRACE_H
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../Utilities/utils.h"
+
+using namespace std;
+
+#include "onevoter.h"
+
+class VoterTrace {
+public:
+/****************************************************************
+ * The header of one block and where its voters are in the file.
+**/
+ struct Block {
+   int pct_number = 0;
+   int station_count = 0;
+   int iteration = 0;
+   int voter_count = 0;
+   long long offset = 0;
+   long long bytes = 0;
+ };
+
+/****************************************************************
+ * One decoded voter, times in seconds from the polls opening.
+**/
+ struct Voter {
+   int arrival_seconds = 0;
+   int start_seconds = 0;
+   int duration_seconds = 0;
+   int station = 0;
+ };
+
+/****************************************************************
+ * Constructors and destructors for the class.
+**/
+ VoterTrace() = default;
+ virtual ~VoterTrace();
+
+/****************************************************************
+ * Accessors.
+**/
+ long long GetBlocks() const;
+ long long GetBytes() const;
+ long long GetVoters() const;
+ bool IsOpen() const;
+
+/****************************************************************
+ * General functions for writing a trace.
+**/
+ static string EncodeIteration(int pct_number, int stations_count,
+                               int iteration,
+                               const VoterMap& voters);
+ void Close();
+ void OpenFile(const string& filename);
+ void Write(const string& blocks);
+ string ToString() const;
+
+/****************************************************************
+ * General functions for reading a trace. Both return false if the
+ * file is not a trace or is cut short.
+**/
+ static bool Decode(const string& filename, const Block& block,
+                    vector<Voter>& voters);
+ static bool ReadIndex(const string& filename, vector<Block>& blocks);
+
+private:
+ long long blocks_ = 0;
+ long long bytes_ = 0;
+ long long voters_ = 0;
+ mutable mutex mutex_;
+ ofstream stream_;
+};
+
+#endif // VOTERTRACE_H